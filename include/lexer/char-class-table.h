@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <unordered_map>
+
+namespace lexer {
+    /**
+     * @brief Maps every character to a small class number.
+     * Characters below FLAT_SIZE are stored in a flat array, so that their
+     * classification is a single load. All other characters are kept in a hash table.
+     */
+    class CharClassTable {
+    public:
+        using class_t = uint16_t;
+
+        /**
+         * @brief The number of characters stored in the flat array.
+         */
+        static constexpr size_t FLAT_SIZE = 256;
+
+    private:
+        std::array<class_t, FLAT_SIZE> _flat;
+        std::unordered_map<wchar_t, class_t> _other;
+        class_t _default_class;
+
+    public:
+        /**
+         * @brief Maps all characters to default_class.
+         *
+         * @param default_class - the class of characters that were not set.
+         */
+        CharClassTable(class_t default_class = 0);
+
+        /**
+         * @brief Maps all characters to default_class again.
+         *
+         * @param default_class - the class of characters that were not set.
+         */
+        void clear(class_t default_class = 0);
+
+        /**
+         * @brief Sets the class of the character.
+         *
+         * @param c - a character.
+         * @param char_class - a class of the character.
+         */
+        void set(wchar_t c, class_t char_class);
+
+        /**
+         * @brief Returns the class of the character.
+         *
+         * @param c - a character.
+         *
+         * @return class_t
+         */
+        inline class_t get(wchar_t c) const {
+            if (static_cast<std::make_unsigned_t<wchar_t>>(c) < FLAT_SIZE) {
+                return _flat[static_cast<std::make_unsigned_t<wchar_t>>(c)];
+            }
+            if (_other.empty()) {
+                return _default_class;
+            }
+            auto it = _other.find(c);
+            return it != _other.end() ? it->second : _default_class;
+        }
+
+        /**
+         * @brief Returns the class of the character.
+         *
+         * @param c - a character.
+         *
+         * @return class_t
+         */
+        inline class_t operator[](wchar_t c) const {
+            return get(c);
+        }
+    };
+}  // namespace lexer
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace lexer {
+    /**
+     * @brief Finds the first occurrence of the delimiter in the text.
+     * A single character is found with wmemchr. A longer delimiter is found by its first
+     * character, and its last character is checked before the full comparison.
+     *
+     * @param text - the text to search in.
+     * @param delimiter - a non-empty delimiter.
+     *
+     * @return size_t - the position of the delimiter or std::wstring_view::npos.
+     */
+    size_t findDelimiter(std::wstring_view text, std::wstring_view delimiter);
+
+    /**
+     * @brief Finds the first occurrence of the delimiter in UTF-8 text.
+     * The search is the same as for wide characters, with memchr instead of wmemchr.
+     *
+     * @param text - the text to search in.
+     * @param delimiter - a non-empty delimiter.
+     *
+     * @return size_t - the position of the delimiter or std::string_view::npos.
+     */
+    size_t findDelimiter(std::string_view text, std::string_view delimiter);
+
+    /**
+     * @brief Finds the first occurrence of the delimiter in UTF-8 text.
+     *
+     * @param text - the text to search in.
+     * @param delimiter - a non-empty delimiter.
+     *
+     * @return size_t - the position of the delimiter or std::u8string_view::npos.
+     */
+    size_t findDelimiter(std::u8string_view text, std::u8string_view delimiter);
+
+    /**
+     * @brief Finds the first occurrence of the delimiter in UTF-16 text.
+     *
+     * @param text - the text to search in.
+     * @param delimiter - a non-empty delimiter.
+     *
+     * @return size_t - the position of the delimiter or std::u16string_view::npos.
+     */
+    size_t findDelimiter(std::u16string_view text, std::u16string_view delimiter);
+}  // namespace lexer
@@ -0,0 +1,597 @@
+#pragma once
+
+#include "lexer-contaner.h"
+#include "dfa-tables.h"
+#include "delimiter-search.h"
+#include "simd-classifier.h"
+#include "unicode.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <initializer_list>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace lexer {
+    /**
+     * @brief Runs a lexer automaton over the text.
+     * The automaton provides the tables as the members _char_classes, _classes_number,
+     * _transitions, _first_region_state, _default_run_state, _ascii_only, _bmp_only and
+     * _quiet_chars and the member templates _closer<InputT>(j) and
+     * _openerSize<InputT>(j), so that the same loop runs over tables built at run time
+     * and at compile time.
+     *
+     * @tparam Automaton - LexerDfa or StaticLexer.
+     */
+    template <class Automaton> class DfaScanner {
+    public:
+        using state_t = DfaTransition::state_t;
+
+        /**
+         * @brief The smallest part of the contents that scan gives to a thread of its
+         * own.
+         */
+        static constexpr size_t PARALLEL_CHUNK_SIZE = 1 << 18;
+
+        /**
+         * @brief Puts ASCII default characters into the set 0 and ASCII separators into
+         * the set 1 of the classifier.
+         *
+         * @param char_classes - the classes of characters.
+         *
+         * @return SimdClassifier
+         */
+        template <class CharClasses>
+        static SimdClassifier quietChars(const CharClasses& char_classes) {
+            SimdClassifier quiet_chars;
+            for (wchar_t c = 0; c < 128; ++c) {
+                if (char_classes[c] == 0) {
+                    quiet_chars.addChar(0, c);
+                } else if (char_classes[c] == 1) {
+                    quiet_chars.addChar(1, c);
+                }
+            }
+            return quiet_chars;
+        }
+
+        /**
+         * @brief The position of a scan that can be stopped and continued.
+         *
+         * @tparam InputT - the character type of the contents.
+         */
+        template <class InputT> struct Cursor {
+            std::basic_string_view<InputT> str;
+            size_t i = 0;
+            state_t state = 0;
+            size_t line_number = 1;
+            size_t region_lines = 0;  // line breaks inside regions of the current row
+            size_t line_start = 0, token_start = 0, region_start = 0;
+            bool finished = false;
+
+            // "false" if more contents may follow str, then the scan stops where it
+            // needs them instead of finishing the tokens
+            bool last = true;
+            size_t searched = 0;  // no closer of the open region starts before it
+
+            // the bitmaps of the block of the contents that starts at block_start
+            size_t block_start = SIZE_MAX;
+            SimdClassifier::masks_t block_masks {};
+
+            Cursor() = default;
+            Cursor(std::basic_string_view<InputT> str) : str(str) {}
+
+            /**
+             * @brief Moves the offsets after the first n units of str are dropped.
+             * The offsets before them become 0.
+             *
+             * @param n - the number of dropped units.
+             */
+            void dropPrefix(size_t n) {
+                for (size_t* offset :
+                     { &i, &line_start, &token_start, &region_start, &searched }) {
+                    *offset -= std::min(*offset, n);
+                }
+                block_start = SIZE_MAX;
+            }
+        };
+
+        /**
+         * @brief Returns the offset of the first character of str that the scan from
+         * the cursor may still put into a token.
+         *
+         * @param automaton - the tables of the automaton.
+         * @param cursor - the position of the scan.
+         *
+         * @return size_t
+         */
+        template <class InputT>
+        static size_t neededStart(const Automaton& automaton,
+                                  const Cursor<InputT>& cursor) {
+            if (cursor.state >= automaton._first_region_state) {
+                return std::min(cursor.i, cursor.region_start);
+            } else if (cursor.state != 0) {
+                return std::min(cursor.i, cursor.token_start);
+            }
+            return cursor.i;
+        }
+
+        /**
+         * @brief Runs the automaton from the cursor until the sink is full or the
+         * contents end. The sink receives the tokens and the rows as offsets in the
+         * contents:
+         * push(from, to, line_number, line_start) for a token,
+         * pushBody(from, to, line_number, line_start) for the body of a region that may
+         * be empty, it returns the number of line breaks in the body,
+         * endLine(line_number, line_start, to) at the end of every row and
+         * isFull() that is checked before every step.
+         * If the cursor is not the last one, the scan stops before a character or a
+         * closer that may continue after str, and the cursor can be continued when str
+         * is extended.
+         *
+         * @param automaton - the tables of the automaton.
+         * @param cursor - the position of the scan, it is moved to where the scan stops.
+         * @param sink - receives the tokens.
+         */
+        template <class InputT, class Sink>
+        static void run(const Automaton& automaton, Cursor<InputT>& cursor, Sink& sink) {
+            const auto& a = automaton;
+            const std::basic_string_view<InputT> str = cursor.str;
+            // the position is kept in locals while the loop runs
+            size_t i = cursor.i;
+            state_t state = cursor.state;
+            size_t line_number = cursor.line_number, region_lines = cursor.region_lines;
+            size_t line_start = cursor.line_start, token_start = cursor.token_start,
+                   region_start = cursor.region_start;
+            auto save = [&]() {
+                cursor.i = i;
+                cursor.state = state;
+                cursor.line_number = line_number;
+                cursor.region_lines = region_lines;
+                cursor.line_start = line_start;
+                cursor.token_start = token_start;
+                cursor.region_start = region_start;
+            };
+            if (cursor.finished) {
+                return;
+            }
+
+            auto push = [&](size_t from, size_t to) {
+                sink.push(from, to, line_number, line_start);
+            };
+            auto endLine = [&](size_t to) {
+                sink.endLine(line_number, line_start, to);
+                line_number += 1 + region_lines;
+                region_lines = 0;
+                line_start = to;
+            };
+
+            // the first stage: bitmaps of default characters and separators of the
+            // current block
+            const SimdClassifier& quiet_chars = a._quiet_chars;
+            const bool skip_runs = quiet_chars.isEnabled();
+            auto skipRun = [&](size_t set, size_t i) {
+                while (i < str.size()) {
+                    size_t start = i - i % SimdClassifier::BLOCK_SIZE;
+                    if (start != cursor.block_start) {
+                        cursor.block_start = start;
+                        cursor.block_masks = quiet_chars.classify(
+                            str.data() + start,
+                            std::min(SimdClassifier::BLOCK_SIZE, str.size() - start));
+                    }
+                    uint64_t stops = ~cursor.block_masks[set] >> (i - start);
+                    if (stops != 0) {
+                        return std::min(i + std::countr_zero(stops), str.size());
+                    }
+                    i = start + SimdClassifier::BLOCK_SIZE;
+                }
+                return str.size();
+            };
+
+            // the second stage: the automaton runs only where the bitmaps have gaps
+            while (i < str.size()) {
+                if (sink.isFull()) {
+                    save();
+                    return;
+                }
+                if (state >= a._first_region_state) {
+                    // the end of a region is searched for directly, the body is pushed
+                    // at once
+                    auto closer =
+                        a.template _closer<InputT>(state - a._first_region_state);
+                    size_t search_start = std::max(i, cursor.searched);
+                    size_t close_start = findDelimiter(str.substr(search_start), closer);
+                    if (close_start == str.npos && !cursor.last) {
+                        // the closer may start in the part that is not scanned yet
+                        cursor.searched = std::max(
+                            search_start, str.size() - std::min(str.size(),
+                                                                closer.size() - 1));
+                        save();
+                        return;
+                    }
+                    if (close_start == str.npos) {
+                        region_lines +=
+                            sink.pushBody(region_start, str.size(), line_number,
+                                          line_start);
+                        state = 0;
+                        i = str.size();
+                        break;
+                    }
+                    close_start += search_start;
+                    size_t body_end = close_start + closer.size() - 1;
+                    region_lines +=
+                        sink.pushBody(region_start, close_start, line_number, line_start);
+                    // a line break that closes the region is counted by the line itself
+                    region_lines += std::count(str.begin() + close_start,
+                                               str.begin() + body_end, InputT('\n'));
+                    push(close_start, body_end + 1);
+                    state = 0;
+                    i = body_end + 1;
+                    if (closer.back() == InputT('\n')) {
+                        endLine(i);
+                    }
+                    continue;
+                }
+
+                if (skip_runs) {
+                    if (state == a._default_run_state) {
+                        i = skipRun(0, i);
+                    } else if (state == 0) {
+                        i = skipRun(1, i);
+                    }
+                    if (i == str.size()) {
+                        break;
+                    }
+                }
+
+                // a character takes more than one unit only if it has to be decoded
+                size_t char_size = 1;
+                CharClassTable::class_t char_class = 0;
+                if constexpr (is_utf8_v<InputT>) {
+                    if (static_cast<unsigned char>(str[i]) < 0x80) {
+                        char_class = a._char_classes[static_cast<wchar_t>(str[i])];
+                    } else if (!a._ascii_only) {
+                        if (!cursor.last && i + utf8CharSize(str[i]) > str.size()) {
+                            break;
+                        }
+                        char32_t c = decodeChar(str.substr(i), char_size);
+                        char_class = a._char_classes[static_cast<wchar_t>(c)];
+                    }
+                } else if constexpr (is_utf16_v<InputT>) {
+                    if (a._bmp_only || str[i] < 0xD800 || str[i] >= 0xDC00) {
+                        char_class = a._char_classes[static_cast<wchar_t>(str[i])];
+                    } else {
+                        if (!cursor.last && i + 2 > str.size()) {
+                            break;
+                        }
+                        char32_t c = decodeChar(str.substr(i), char_size);
+                        char_class = a._char_classes[static_cast<wchar_t>(c)];
+                    }
+                } else {
+                    char_class = a._char_classes[str[i]];
+                }
+                const DfaTransition& t =
+                    a._transitions[state * a._classes_number + char_class];
+                state = t.next;
+                const size_t next_i = i + char_size;
+                if (t.actions == 0) {
+                    i = next_i;
+                    continue;
+                }
+
+                if (t.actions & DfaTransition::FLUSH_BEFORE) {
+                    push(token_start, i);
+                }
+                if (t.actions & DfaTransition::OPEN_BEFORE) {
+                    size_t open_start = i - a.template _openerSize<InputT>(t.opener);
+                    if (open_start > token_start) {
+                        push(token_start, open_start);
+                    }
+                    push(open_start, i);
+                    region_start = i;
+                    continue;
+                }
+                if (t.actions & DfaTransition::START) {
+                    token_start = i;
+                }
+                if (t.actions & DfaTransition::EMIT_SELF) {
+                    push(i, next_i);
+                }
+                if (t.actions & DfaTransition::FLUSH_AFTER) {
+                    push(token_start, next_i);
+                }
+                if (t.actions & DfaTransition::OPEN_AFTER) {
+                    region_start = next_i;
+                }
+                if (t.actions & DfaTransition::END_LINE) {
+                    endLine(next_i);
+                }
+                i = next_i;
+            }
+
+            if (!cursor.last) {
+                save();
+                return;
+            }
+            if (state >= a._first_region_state) {
+                if (str.size() > region_start) {
+                    push(region_start, str.size());
+                }
+            } else if (state != 0) {
+                push(token_start, str.size());
+            }
+            endLine(str.size());
+            state = 0;
+            save();
+            cursor.finished = true;
+        }
+
+        /**
+         * @brief Starts lexical analysis of UTF-8, UTF-16 or wide contents and builds
+         * tokens of the character type CharT.
+         *
+         * @param automaton - the tables of the automaton.
+         * @param str - the contents.
+         * @param tokenId - identifies tokens, the bodies of regions are hashed while
+         * their lines are counted if it is incremental.
+         * @param source - the text the contents view, the contents are copied if it is
+         * null and the tokens are in the encoding of the contents.
+         * @param interner - interns the token texts if it is not null.
+         * @param threads - the contents in the encoding of the tokens are divided into
+         * this number of chunks at line breaks, the chunks are lexed at once.
+         * @param resource - the columns of the container are allocated from it, the
+         * default memory resource is used if it is null.
+         *
+         * @return BasicLexerContaner<CharT>
+         */
+        template <class CharT, class InputT>
+        static BasicLexerContaner<CharT>
+        scan(const Automaton& automaton, std::basic_string_view<InputT> str,
+             const BasicTokenIdentifier<CharT>& tokenId,
+             typename BasicLexerContaner<CharT>::source_t source = nullptr,
+             std::shared_ptr<BasicTokenInterner<CharT>> interner = nullptr,
+             size_t threads = 1, std::pmr::memory_resource* resource = nullptr) {
+            // the offsets refer to the contents if they are in the token encoding,
+            // otherwise the texts are converted and copied
+            constexpr bool same_encoding =
+                std::is_same_v<InputT, CharT> || (is_utf8_v<InputT> && is_utf8_v<CharT>);
+            if constexpr (same_encoding) {
+                if (source == nullptr) {
+                    source = std::make_shared<const std::basic_string<CharT>>(
+                        reinterpret_cast<const CharT*>(str.data()), str.size());
+                }
+            } else {
+                source = nullptr;
+            }
+            if constexpr (same_encoding) {
+                if (threads > 1 && str.size() >= 2 * PARALLEL_CHUNK_SIZE) {
+                    return _scanParallel(automaton, str, tokenId, std::move(source),
+                                         std::move(interner), threads, resource);
+                }
+            }
+
+            _ContanerSink<CharT, InputT> sink { str, tokenId,
+                                                BasicLexerContanerBuilder<CharT>(
+                                                    std::move(source),
+                                                    std::move(interner), resource) };
+            Cursor<InputT> cursor(str);
+            run(automaton, cursor, sink);
+            return sink.builder.build();
+        }
+
+    private:
+        // builds a container of all tokens
+        template <class CharT, class InputT> struct _ContanerSink {
+            static constexpr bool same_encoding =
+                std::is_same_v<InputT, CharT> || (is_utf8_v<InputT> && is_utf8_v<CharT>);
+
+            std::basic_string_view<InputT> str;
+            const BasicTokenIdentifier<CharT>& tokenId;
+            BasicLexerContanerBuilder<CharT> builder;
+
+            void push(size_t from, size_t to, size_t, size_t) {
+                if constexpr (same_encoding) {
+                    std::basic_string_view<CharT> text(
+                        reinterpret_cast<const CharT*>(str.data()) + from, to - from);
+                    builder.addToken(tokenId(text), from, to - from);
+                } else {
+                    size_t offset = builder.appendConverted(str.substr(from, to - from));
+                    std::basic_string_view<CharT> text = builder.getCopy(offset);
+                    builder.addToken(tokenId(text), offset, text.size());
+                }
+            }
+
+            // a region body may be long, it is hashed in the pass that counts its lines
+            size_t pushBody(size_t from, size_t to, size_t line_number,
+                            size_t line_start) {
+                if constexpr (same_encoding) {
+                    std::basic_string_view<CharT> text(
+                        reinterpret_cast<const CharT*>(str.data()) + from, to - from);
+                    size_t lines = 0;
+                    uint64_t id = tokenId.identifyCountingLines(text, lines);
+                    if (to > from) {
+                        builder.addToken(id, from, to - from);
+                    }
+                    return lines;
+                } else {
+                    if (to > from) {
+                        push(from, to, line_number, line_start);
+                    }
+                    return std::count(str.begin() + from, str.begin() + to,
+                                      InputT('\n'));
+                }
+            }
+
+            void endLine(size_t line_number, size_t line_start, size_t to) {
+                if (builder.isLineEmpty()) {
+                    return;
+                }
+                if constexpr (same_encoding) {
+                    builder.endLine(line_number, line_start, to - line_start);
+                } else {
+                    size_t offset =
+                        builder.appendConverted(str.substr(line_start, to - line_start));
+                    builder.endLine(line_number, offset, builder.getCopy(offset).size());
+                }
+            }
+
+            static constexpr bool isFull() {
+                return false;
+            }
+        };
+
+        // the end of a row of a chunk lexed on its own
+        struct _RowEnd {
+            size_t to;
+            size_t tokens, rows;  // the numbers of tokens and rows of the chunk before it
+            size_t line_number;   // the number of the row in the chunk
+        };
+
+        // lexes a chunk from a row start as if no region was open before it
+        template <class CharT, class InputT>
+        struct _ChunkSink : _ContanerSink<CharT, InputT> {
+            std::vector<_RowEnd> row_ends;
+
+            void endLine(size_t line_number, size_t line_start, size_t to) {
+                _ContanerSink<CharT, InputT>::endLine(line_number, line_start, to);
+                row_ends.push_back(_RowEnd { to, this->builder.getTokensNumber(),
+                                             this->builder.getLinesNumber(),
+                                             line_number });
+            }
+        };
+
+        // continues the true scan into a chunk until a row ends where a row of the
+        // chunk ends, from there the states of both scans are the same
+        template <class CharT, class InputT> struct _ResolveSink {
+            _ContanerSink<CharT, InputT>& sink;
+            const std::vector<_RowEnd>& row_ends;
+            size_t met = SIZE_MAX;  // the index of the common row end
+
+            void push(size_t from, size_t to, size_t line_number, size_t line_start) {
+                sink.push(from, to, line_number, line_start);
+            }
+
+            size_t pushBody(size_t from, size_t to, size_t line_number,
+                            size_t line_start) {
+                return sink.pushBody(from, to, line_number, line_start);
+            }
+
+            void endLine(size_t line_number, size_t line_start, size_t to) {
+                sink.endLine(line_number, line_start, to);
+                auto row_end = std::lower_bound(
+                    row_ends.begin(), row_ends.end(), to,
+                    [](const _RowEnd& row_end, size_t to) { return row_end.to < to; });
+                if (row_end != row_ends.end() && row_end->to == to) {
+                    met = static_cast<size_t>(row_end - row_ends.begin());
+                }
+            }
+
+            bool isFull() const {
+                return met != SIZE_MAX;
+            }
+        };
+
+        // the chunks are lexed at once from row starts; a chunk that starts inside a
+        // region is then continued by the true scan until both scans end the same row,
+        // and the rest of the chunk is taken as it is
+        template <class CharT, class InputT>
+        static BasicLexerContaner<CharT>
+        _scanParallel(const Automaton& automaton, std::basic_string_view<InputT> str,
+                      const BasicTokenIdentifier<CharT>& tokenId,
+                      typename BasicLexerContaner<CharT>::source_t source,
+                      std::shared_ptr<BasicTokenInterner<CharT>> interner,
+                      size_t threads, std::pmr::memory_resource* resource) {
+            std::vector<size_t> ends;
+            const size_t chunks = std::min(threads, str.size() / PARALLEL_CHUNK_SIZE);
+            for (size_t c = 1; c < chunks; ++c) {
+                size_t from = std::max(str.size() / chunks * c,
+                                       ends.empty() ? 0 : ends.back());
+                size_t line_break = str.find(InputT('\n'), from);
+                if (line_break == str.npos || line_break + 1 == str.size()) {
+                    break;
+                }
+                ends.push_back(line_break + 1);
+            }
+            ends.push_back(str.size());
+
+            std::vector<Cursor<InputT>> cursors(ends.size());
+            std::vector<_ChunkSink<CharT, InputT>> chunk_sinks;
+            chunk_sinks.reserve(ends.size());
+            // the first chunk receives the others, only it takes the memory resource
+            chunk_sinks.push_back(_ChunkSink<CharT, InputT> {
+                { str, tokenId,
+                  BasicLexerContanerBuilder<CharT>(std::move(source),
+                                                   std::move(interner), resource) },
+                {} });
+            for (size_t c = 1; c < ends.size(); ++c) {
+                chunk_sinks.push_back(_ChunkSink<CharT, InputT> {
+                    { str, tokenId, BasicLexerContanerBuilder<CharT>() }, {} });
+            }
+            auto lexChunk = [&](size_t c) {
+                Cursor<InputT>& cursor = cursors[c];
+                cursor.str = str.substr(0, ends[c]);
+                cursor.i = cursor.line_start = cursor.token_start = cursor.region_start =
+                    c == 0 ? 0 : ends[c - 1];
+                cursor.last = c + 1 == ends.size();
+                run(automaton, cursor, chunk_sinks[c]);
+            };
+            std::vector<std::thread> workers;
+            for (size_t c = 1; c < ends.size(); ++c) {
+                workers.emplace_back(lexChunk, c);
+            }
+            lexChunk(0);
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+
+            // the true scan is continued into the chunks that start inside regions,
+            // the parts of the chunks that it does not lex are added as they are
+            using part_t = typename BasicLexerContanerBuilder<CharT>::Part;
+            std::vector<part_t> parts;
+            std::vector<_ContanerSink<CharT, InputT>> fixes;
+            fixes.reserve(ends.size());
+            Cursor<InputT> cursor = cursors[0];
+            for (size_t c = 1; c < ends.size(); ++c) {
+                const _ChunkSink<CharT, InputT>& chunk = chunk_sinks[c];
+                size_t first_token = 0, first_row = 0;
+                // the number of the row in the chunk after the place it is taken from
+                size_t chunk_line_number = 1;
+                if (cursor.state != 0) {
+                    cursor.str = str.substr(0, ends[c]);
+                    cursor.last = c + 1 == ends.size();
+                    cursor.block_start = SIZE_MAX;
+                    fixes.push_back(_ContanerSink<CharT, InputT> {
+                        str, tokenId, BasicLexerContanerBuilder<CharT>() });
+                    _ResolveSink<CharT, InputT> resolve { fixes.back(), chunk.row_ends };
+                    run(automaton, cursor, resolve);
+                    parts.push_back(part_t { &fixes.back().builder, 0, 0, 0 });
+                    if (!resolve.isFull()) {
+                        // no row of the chunk was lexed right
+                        continue;
+                    }
+                    const _RowEnd& met = chunk.row_ends[resolve.met];
+                    first_token = met.tokens;
+                    first_row = met.rows;
+                    // the number of a row is known when the next row ends
+                    chunk_line_number = resolve.met + 1 < chunk.row_ends.size()
+                                            ? chunk.row_ends[resolve.met + 1].line_number
+                                            : cursors[c].line_number;
+                }
+                const size_t line_shift = cursor.line_number - chunk_line_number;
+                parts.push_back(part_t { &chunk.builder, first_token, first_row,
+                                         line_shift });
+                cursor = cursors[c];
+                cursor.line_number += line_shift;
+            }
+
+            // the first chunk was lexed into the container with the source
+            BasicLexerContanerBuilder<CharT>& builder = chunk_sinks[0].builder;
+            builder.append(parts, threads);
+            return builder.build();
+        }
+    };
+}  // namespace lexer
@@ -0,0 +1,550 @@
+#pragma once
+
+#include "char-class-table.h"
+#include "unicode.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace lexer {
+    /**
+     * @brief A transition of the lexer automaton.
+     */
+    struct DfaTransition {
+        using state_t = uint32_t;
+
+        /**
+         * @brief The actions of the transition.
+         */
+        enum Action : uint16_t {
+            FLUSH_BEFORE = 1 << 0,  // push the pending token, the character is not in it
+            OPEN_BEFORE = 1 << 1,   // the pending token ends with an opener, push both
+                                    // parts and read the character again inside the
+                                    // region
+            START = 1 << 2,         // the character starts a new pending token
+            EMIT_SELF = 1 << 3,     // push the character as a separate token
+            FLUSH_AFTER = 1 << 4,   // push the pending token including the character
+            OPEN_AFTER = 1 << 5,    // a region starts after the character
+            END_LINE = 1 << 6       // the character completes the line
+        };
+
+        state_t next;
+        uint16_t actions;
+        uint16_t opener;  // the combining token opened by OPEN_BEFORE
+    };
+
+    /**
+     * @brief A node of the Aho-Corasick automaton of the initial combining tokens.
+     */
+    struct DfaOpenerNode {
+        size_t depth;       // the number of characters from the root
+        long opener;        // the initial token that ends at the node, -1 if none
+        long glued_opener;  // the longest initial token of a special alphabet that is
+                            // a suffix of the node, -1 if none
+    };
+
+    /**
+     * @brief The characters of the special alphabets grouped by the sets of alphabets
+     * they belong to. Two characters are of the same alphabet if some alphabet
+     * contains both, i.e. if the sets of their groups intersect.
+     */
+    struct AlphabetGroups {
+        /**
+         * @brief The group of every character of the alphabets sorted by the
+         * characters.
+         */
+        std::vector<std::pair<wchar_t, size_t>> char_groups;
+
+        size_t groups_number;
+
+        /**
+         * @brief groups_number flags of every group, the flag is set if the sets of
+         * alphabets of the groups intersect.
+         */
+        std::vector<bool> overlaps;
+
+        constexpr bool overlap(size_t a, size_t b) const {
+            return overlaps[a * groups_number + b];
+        }
+    };
+
+    /**
+     * @brief The tables of the lexer automaton.
+     */
+    struct DfaTables {
+        using state_t = DfaTransition::state_t;
+
+        /**
+         * @brief The classes of the characters sorted by the characters, all other
+         * characters have the class 0.
+         */
+        std::vector<std::pair<wchar_t, CharClassTable::class_t>> char_classes;
+
+        size_t classes_number;
+
+        /**
+         * @brief classes_number transitions of every state.
+         */
+        std::vector<DfaTransition> transitions;
+
+        /**
+         * @brief The state of a region of the j-th combining token is
+         * first_region_state + j.
+         */
+        state_t first_region_state;
+
+        /**
+         * @brief The state of a pending token of default characters.
+         */
+        state_t default_run_state;
+
+        /**
+         * @brief The Aho-Corasick automaton of the initial tokens, the node 0 is the
+         * root. It has classes_number transitions of every node, they follow the
+         * suffix links.
+         */
+        std::vector<DfaOpenerNode> opener_nodes;
+        std::vector<state_t> opener_transitions;
+
+        std::vector<std::wstring> closers;
+        std::vector<size_t> opener_sizes;
+        std::vector<std::string> utf8_closers;
+        std::vector<size_t> utf8_opener_sizes;
+        std::vector<std::u16string> utf16_closers;
+        std::vector<size_t> utf16_opener_sizes;
+
+        /**
+         * @brief "true" if all characters of the configuration are ASCII.
+         */
+        bool ascii_only;
+
+        /**
+         * @brief "true" if all characters of the configuration are in the BMP.
+         */
+        bool bmp_only;
+    };
+
+    /**
+     * @brief Compiles the lexer configuration into the tables of the automaton.
+     * The compilation is a constant expression, so that the tables of a configuration
+     * known at compile time are built by the compiler.
+     */
+    class DfaBuilder {
+    public:
+        using combining_view_t = std::pair<std::wstring_view, std::wstring_view>;
+
+    private:
+        enum class _CharKind {
+            Default,
+            Separator,
+            Individual,
+            Alphabet
+        };
+
+        struct _ClassInfo {
+            _CharKind kind;
+            size_t alphabet;
+            bool has_char;
+            wchar_t c;
+        };
+
+        struct _TrieNode {
+            std::vector<std::pair<wchar_t, size_t>> children;
+            size_t alphabet;  // 0 - the last char is not from special alphabets, g + 1 -
+                              // from the g-th group of the alphabets
+            size_t depth;
+            long opener;
+            size_t suffix;      // the longest proper suffix that is a node too
+            long glued_opener;  // the longest initial token of a special alphabet that
+                                // is a suffix of the node
+        };
+
+        // the root is never a child, so 0 means that there is no child
+        static constexpr size_t _child(const _TrieNode& node, wchar_t c) {
+            for (const auto& [child_c, child] : node.children) {
+                if (child_c == c) {
+                    return child;
+                }
+            }
+            return 0;
+        }
+
+        static constexpr bool _isAscii(std::wstring_view chars) {
+            return std::all_of(chars.begin(), chars.end(), [](wchar_t c) {
+                return static_cast<std::make_unsigned_t<wchar_t>>(c) < 0x80;
+            });
+        }
+
+        static constexpr bool _isBmp(std::wstring_view chars) {
+            return std::all_of(chars.begin(), chars.end(), [](wchar_t c) {
+                return static_cast<std::make_unsigned_t<wchar_t>>(c) <= 0xFFFF;
+            });
+        }
+
+    public:
+        /**
+         * @brief Groups the characters of the special alphabets by the sets of
+         * alphabets they belong to.
+         *
+         * @param special_alphabets - a list of alphabets.
+         *
+         * @return AlphabetGroups
+         */
+        static constexpr AlphabetGroups
+        groupAlphabets(std::span<const std::wstring_view> special_alphabets) {
+            std::vector<std::pair<wchar_t, std::vector<size_t>>> char_sets;
+            for (size_t k = 0; k < special_alphabets.size(); ++k) {
+                for (wchar_t c : special_alphabets[k]) {
+                    auto it =
+                        std::find_if(char_sets.begin(), char_sets.end(),
+                                     [c](const auto& entry) { return entry.first == c; });
+                    if (it == char_sets.end()) {
+                        char_sets.push_back({ c, { k } });
+                    } else if (it->second.back() != k) {
+                        it->second.push_back(k);
+                    }
+                }
+            }
+
+            AlphabetGroups groups;
+            std::vector<std::vector<size_t>> sets;
+            for (const auto& [c, set] : char_sets) {
+                auto it = std::find(sets.begin(), sets.end(), set);
+                groups.char_groups.push_back(
+                    { c, static_cast<size_t>(it - sets.begin()) });
+                if (it == sets.end()) {
+                    sets.push_back(set);
+                }
+            }
+            std::sort(groups.char_groups.begin(), groups.char_groups.end());
+
+            // the sets are sorted, so they intersect if a merge meets equal alphabets
+            groups.groups_number = sets.size();
+            groups.overlaps.assign(sets.size() * sets.size(), false);
+            for (size_t a = 0; a < sets.size(); ++a) {
+                for (size_t b = 0; b < sets.size(); ++b) {
+                    size_t i = 0, j = 0;
+                    while (i < sets[a].size() && j < sets[b].size() &&
+                           sets[a][i] != sets[b][j]) {
+                        sets[a][i] < sets[b][j] ? ++i : ++j;
+                    }
+                    groups.overlaps[a * sets.size() + b] =
+                        i < sets[a].size() && j < sets[b].size();
+                }
+            }
+            return groups;
+        }
+
+        /**
+         * @brief Compiles the lexer configuration.
+         *
+         * @param special_alphabets - a list of alphabets.
+         * @param individual_chars - a list of characters, each of which is regarded as a
+         * separate alphabet.
+         * @param combining_tokens - the initial and the final tokens between which all
+         * symbols are considered as a single token.
+         * @param separators - symbols used to separate words.
+         *
+         * @return DfaTables
+         */
+        static constexpr DfaTables
+        build(std::span<const std::wstring_view> special_alphabets,
+              std::wstring_view individual_chars,
+              std::span<const combining_view_t> combining_tokens,
+              std::wstring_view separators) {
+            using class_t = CharClassTable::class_t;
+            using state_t = DfaTransition::state_t;
+            DfaTables tables;
+
+            // the character kinds have the same priority as in Lexer
+            std::vector<_ClassInfo> classes = {
+                { _CharKind::Default, 0, false, 0 },
+                { _CharKind::Separator, 0, false, 0 },
+                { _CharKind::Individual, 0, false, 0 }
+            };
+            // a pending token of special alphabets is broken by a character whose
+            // alphabets have none in common with the ones of the last character
+            const AlphabetGroups groups = groupAlphabets(special_alphabets);
+            for (size_t g = 0; g < groups.groups_number; ++g) {
+                classes.push_back({ _CharKind::Alphabet, g, false, 0 });
+            }
+            auto kindOf = [&](wchar_t c) -> class_t {
+                if (individual_chars.find(c) != individual_chars.npos) {
+                    return 2;
+                }
+                for (const auto& [group_c, group] : groups.char_groups) {
+                    if (group_c == c) {
+                        return static_cast<class_t>(3 + group);
+                    }
+                }
+                return separators.find(c) != separators.npos ? 1 : 0;
+            };
+            auto setClass = [&](wchar_t c, class_t char_class) {
+                for (auto& [class_c, old_class] : tables.char_classes) {
+                    if (class_c == c) {
+                        old_class = char_class;
+                        return;
+                    }
+                }
+                tables.char_classes.push_back({ c, char_class });
+            };
+            for (std::wstring_view chars : { separators, individual_chars }) {
+                for (wchar_t c : chars) {
+                    setClass(c, kindOf(c));
+                }
+            }
+            for (std::wstring_view alphabet : special_alphabets) {
+                for (wchar_t c : alphabet) {
+                    setClass(c, kindOf(c));
+                }
+            }
+
+            // the line break and the characters of initial tokens get their own classes
+            std::vector<wchar_t> own_chars;
+            auto addOwnClass = [&](wchar_t c) {
+                if (std::find(own_chars.begin(), own_chars.end(), c) == own_chars.end()) {
+                    const _ClassInfo kind = classes[kindOf(c)];
+                    own_chars.push_back(c);
+                    setClass(c, static_cast<class_t>(classes.size()));
+                    classes.push_back({ kind.kind, kind.alphabet, true, c });
+                }
+            };
+            addOwnClass(L'\n');
+            for (const auto& [opener, closer] : combining_tokens) {
+                for (wchar_t c : opener) {
+                    addOwnClass(c);
+                }
+            }
+            std::sort(tables.char_classes.begin(), tables.char_classes.end());
+            const size_t classes_number = classes.size();
+            tables.classes_number = classes_number;
+
+            // UTF-8 input is decoded only if some character of the configuration is not
+            // ASCII, and UTF-16 surrogate pairs only if it has characters out of the BMP
+            tables.ascii_only =
+                _isAscii(separators) && _isAscii(individual_chars) &&
+                std::all_of(special_alphabets.begin(), special_alphabets.end(),
+                            _isAscii) &&
+                std::all_of(combining_tokens.begin(), combining_tokens.end(),
+                            [](const combining_view_t& combining_token) {
+                                return _isAscii(combining_token.first);
+                            });
+            tables.bmp_only =
+                _isBmp(separators) && _isBmp(individual_chars) &&
+                std::all_of(special_alphabets.begin(), special_alphabets.end(), _isBmp) &&
+                std::all_of(combining_tokens.begin(), combining_tokens.end(),
+                            [](const combining_view_t& combining_token) {
+                                return _isBmp(combining_token.first);
+                            });
+
+            // an Aho-Corasick automaton of the initial tokens
+            std::vector<_TrieNode> trie = { _TrieNode { {}, 0, 0, -1, 0, -1 } };
+            const size_t combining_number = combining_tokens.size();
+            tables.closers.assign(combining_number, L"");
+            tables.utf8_closers.assign(combining_number, "");
+            tables.utf16_closers.assign(combining_number, u"");
+            tables.opener_sizes.assign(combining_number, 0);
+            tables.utf8_opener_sizes.assign(combining_number, 0);
+            tables.utf16_opener_sizes.assign(combining_number, 0);
+            for (size_t j = 0; j < combining_number; ++j) {
+                const auto& [opener, closer] = combining_tokens[j];
+                tables.closers[j] = closer;
+                if (opener.empty() || closer.empty()) {
+                    continue;
+                }
+                tables.utf8_closers[j] = wideToUtf8(closer);
+                tables.utf16_closers[j] = wideToUtf16(closer);
+                tables.opener_sizes[j] = opener.size();
+                tables.utf8_opener_sizes[j] = wideToUtf8(opener).size();
+                tables.utf16_opener_sizes[j] = wideToUtf16(opener).size();
+                size_t node = 0;
+                for (wchar_t c : opener) {
+                    size_t child = _child(trie[node], c);
+                    if (child == 0) {
+                        const _ClassInfo& kind = classes[kindOf(c)];
+                        size_t alphabet =
+                            kind.kind == _CharKind::Alphabet ? kind.alphabet + 1 : 0;
+                        child = trie.size();
+                        trie[node].children.push_back({ c, child });
+                        trie.push_back(
+                            _TrieNode { {}, alphabet, trie[node].depth + 1, -1, 0, -1 });
+                    }
+                    node = child;
+                }
+                if (trie[node].opener < 0) {
+                    trie[node].opener = static_cast<long>(j);
+                }
+            }
+
+            // the suffix links are built in the breadth-first order
+            std::vector<size_t> order = { 0 };
+            for (size_t k = 0; k < order.size(); ++k) {
+                for (const auto& [c, child] : trie[order[k]].children) {
+                    order.push_back(child);
+                }
+            }
+            auto step = [&](size_t node, wchar_t c) -> size_t {
+                while (true) {
+                    size_t child = _child(trie[node], c);
+                    if (child != 0) {
+                        return child;
+                    }
+                    if (node == 0) {
+                        return 0;
+                    }
+                    node = trie[node].suffix;
+                }
+            };
+            for (size_t node : order) {
+                if (node != 0) {
+                    bool glued = trie[node].opener >= 0 && trie[node].alphabet != 0;
+                    trie[node].glued_opener = glued
+                                                  ? trie[node].opener
+                                                  : trie[trie[node].suffix].glued_opener;
+                }
+                for (const auto& [c, child] : trie[node].children) {
+                    trie[child].suffix = node == 0 ? 0 : step(trie[node].suffix, c);
+                }
+            }
+
+            // the automaton of the initial tokens is also run by the classic lexer
+            for (const _TrieNode& node : trie) {
+                tables.opener_nodes.push_back(
+                    { node.depth, node.opener, node.glued_opener });
+            }
+            tables.opener_transitions.assign(trie.size() * classes_number, 0);
+            for (size_t node = 0; node < trie.size(); ++node) {
+                for (size_t x = 0; x < classes_number; ++x) {
+                    if (classes[x].has_char) {
+                        tables.opener_transitions[node * classes_number + x] =
+                            static_cast<state_t>(step(node, classes[x].c));
+                    }
+                }
+            }
+
+            // states: 0 - no pending token, [1, nodes) - the pending token is a prefix
+            // of an initial token, [nodes, 2 * nodes - 1) - only a suffix of the pending
+            // token is a prefix of an initial token, then a pending token of every
+            // group of the alphabets, then a region of every combining token
+            const size_t nodes = trie.size();
+            const size_t dead_states = 2 * nodes - 1;
+            const size_t alphabets_number = groups.groups_number + 1;
+            const size_t first_region_state = dead_states + alphabets_number;
+            tables.first_region_state = static_cast<state_t>(first_region_state);
+            tables.default_run_state = static_cast<state_t>(dead_states);
+            tables.transitions.assign((first_region_state + combining_number) *
+                                          classes_number,
+                                      DfaTransition { 0, 0, 0 });
+
+            for (size_t s = 0; s < first_region_state; ++s) {
+                bool empty = s == 0;
+                bool dead = s >= dead_states;
+                bool whole = s < nodes;
+                size_t node = dead || empty ? 0 : (whole ? s : s - nodes + 1);
+                size_t alphabet = dead ? s - dead_states : trie[node].alphabet;
+                // the pending token as a whole or its special alphabet suffix is an
+                // initial token
+                long opener = whole && trie[node].opener >= 0 ? trie[node].opener
+                                                              : trie[node].glued_opener;
+
+                for (size_t x = 0; x < classes_number; ++x) {
+                    const _ClassInfo& info = classes[x];
+                    bool new_line = info.has_char && info.c == L'\n';
+                    DfaTransition& t = tables.transitions[s * classes_number + x];
+
+                    auto open = [&]() {
+                        t.actions = DfaTransition::OPEN_BEFORE;
+                        t.opener = static_cast<uint16_t>(opener);
+                        t.next = static_cast<state_t>(first_region_state + opener);
+                    };
+                    auto flushBefore = [&]() {
+                        if (opener >= 0) {
+                            open();
+                            return true;
+                        }
+                        t.actions |= DfaTransition::FLUSH_BEFORE;
+                        return false;
+                    };
+
+                    if (info.kind == _CharKind::Individual) {
+                        if (!empty && flushBefore()) {
+                            continue;
+                        }
+                        t.actions |= DfaTransition::EMIT_SELF;
+                        long self_opener = -1;
+                        if (info.has_char) {
+                            size_t child = _child(trie[0], info.c);
+                            if (child != 0) {
+                                self_opener = trie[child].opener;
+                            }
+                        }
+                        if (self_opener >= 0) {
+                            t.actions |= DfaTransition::OPEN_AFTER;
+                            t.next =
+                                static_cast<state_t>(first_region_state + self_opener);
+                        } else if (new_line) {
+                            t.actions |= DfaTransition::END_LINE;
+                        }
+                    } else if (info.kind == _CharKind::Separator) {
+                        if (!empty && flushBefore()) {
+                            continue;
+                        }
+                        if (new_line) {
+                            t.actions |= DfaTransition::END_LINE;
+                        }
+                    } else {
+                        size_t char_alphabet =
+                            info.kind == _CharKind::Alphabet ? info.alphabet + 1 : 0;
+                        size_t next_node = node;
+                        bool next_whole = whole;
+                        if (empty) {
+                            t.actions |= DfaTransition::START;
+                            next_whole = true;
+                        } else if (char_alphabet != 0 &&
+                                   (alphabet == 0 ||
+                                    !groups.overlap(alphabet - 1, char_alphabet - 1))) {
+                            if (flushBefore()) {
+                                continue;
+                            }
+                            t.actions |= DfaTransition::START;
+                            next_node = 0;
+                            next_whole = true;
+                        } else if (trie[node].glued_opener >= 0 &&
+                                   (!info.has_char || _child(trie[node], info.c) == 0)) {
+                            // the character can not make the glued initial token longer
+                            open();
+                            continue;
+                        }
+
+                        size_t child =
+                            info.has_char ? _child(trie[next_node], info.c) : 0;
+                        if (child != 0) {
+                            next_node = child;
+                        } else {
+                            next_node = info.has_char ? step(next_node, info.c) : 0;
+                            next_whole = false;
+                        }
+                        if (next_node == 0) {
+                            t.next = static_cast<state_t>(dead_states + char_alphabet);
+                        } else {
+                            t.next = static_cast<state_t>(
+                                next_whole ? next_node : nodes + next_node - 1);
+                        }
+                        if (new_line) {
+                            // a token that completes the line never opens a region
+                            t.actions |=
+                                DfaTransition::FLUSH_AFTER | DfaTransition::END_LINE;
+                            t.next = 0;
+                        }
+                    }
+                }
+            }
+            return tables;
+        }
+    };
+}  // namespace lexer
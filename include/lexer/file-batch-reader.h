@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lexer {
+    /**
+     * @brief Reads many files in the background and hands out each file as soon as its
+     * contents have been read, in the order the reads complete.
+     * On Linux the reads of regular files are submitted through io_uring, so one
+     * thread keeps up to queue_depth reads in flight. If io_uring is not available the
+     * files are read by a pool of threads with pread. The number of files that are
+     * being read or have not been taken by next is limited by queue_depth, so the
+     * memory does not depend on the number of files.
+     */
+    class FileBatchReader {
+    public:
+        /**
+         * @brief The number of reads in flight if it is not given.
+         */
+        static constexpr size_t DEFAULT_QUEUE_DEPTH = 64;
+
+        /**
+         * @brief The largest number of threads of the pool used without io_uring.
+         */
+        static constexpr size_t MAX_POOL_THREADS = 16;
+
+    private:
+        struct _Ring;
+
+        struct _ReadFile {
+            size_t index;
+            std::string contents;
+            std::exception_ptr error;
+        };
+
+        std::vector<std::string> _file_names;
+        size_t _queue_depth;
+        std::unique_ptr<_Ring> _ring;  // null if the pool reads the files
+
+        std::mutex _mutex;
+        std::condition_variable _read_cv;   // a file has been read
+        std::condition_variable _taken_cv;  // a read file has been taken or reading stops
+        std::deque<_ReadFile> _read_files;
+        size_t _reading;  // files reserved by _reserve and not delivered yet
+        size_t _taken;
+        bool _stopped;
+
+        std::atomic<size_t> _next_file;  // the next file a thread of the pool reads
+        std::vector<std::thread> _threads;
+
+        bool _reserve(bool wait);
+        void _release();
+        void _deliver(size_t index, std::string&& contents, std::exception_ptr error);
+        void _readAndDeliver(size_t index);
+        void _readWithRing();
+        void _readWithPool();
+
+    public:
+        /**
+         * @brief Starts reading the files.
+         *
+         * @param file_names - the names of the files.
+         * @param queue_depth - the number of reads in flight and of read files that
+         * wait to be taken.
+         */
+        FileBatchReader(std::vector<std::string> file_names,
+                        size_t queue_depth = DEFAULT_QUEUE_DEPTH);
+
+        FileBatchReader(const FileBatchReader&) = delete;
+        FileBatchReader& operator=(const FileBatchReader&) = delete;
+
+        /**
+         * @brief Stops reading, the reads in flight are waited for.
+         */
+        ~FileBatchReader();
+
+        /**
+         * @brief Waits for the next read file and takes it. It may be called by several
+         * threads at once. If the file could not be read, the index is set and the
+         * error is thrown.
+         *
+         * @param index - receives the index of the file in the list of names.
+         * @param contents - receives the contents of the file.
+         *
+         * @return bool - "false" if all files have been taken.
+         */
+        bool next(size_t& index, std::string& contents);
+
+        /**
+         * @brief Returns the number of files.
+         *
+         * @return size_t
+         */
+        size_t getSize() const;
+
+        /**
+         * @brief Returns "true" if the files are read through io_uring.
+         *
+         * @return bool
+         */
+        bool usesIoUring() const;
+    };
+}  // namespace lexer
@@ -1,204 +1,422 @@
+#pragma once
+
 #include "lexer-iterator.h"
+#include "token-interner.h"
+#include "unicode.h"
+
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace lexer {
+    template <class CharT> class BasicLexerContanerBuilder;
+    template <class CharT> class BasicLexerContanerView;
+
     /**
      * @brief It serves as a token storage.
+     * The tokens are stored by columns: the ids, the offsets and the lengths of the
+     * texts are contiguous arrays, and the rows are ranges of tokens. The texts are
+     * kept in one buffer shared by copies of the storage, it is the analysed text
+     * itself when the tokens were created in its encoding. The rows of BasicTokenLine
+     * are built once on the first use of the row interface, their tokens refer to the
+     * buffer (see BasicToken::makeView); the rows are read-only. The iterators read
+     * the tokens from the columns and do not build the rows, so they move by any
+     * number of tokens in constant time and visiting the tokens allocates nothing.
+     * If the tokens were interned, the storage also keeps the dense ids of the texts;
+     * the token texts still refer to the buffer.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
      */
-    class LexerContaner {
-        lexer_contaner_t _contaner;
-        size_t _size;
+    template <class CharT> class BasicLexerContaner {
+    public:
+        using contaner_t = basic_lexer_contaner_t<CharT>;
+        using line_t = BasicTokenLine<CharT>;
+        using token_t = BasicToken<CharT>;
+        using view_t = BasicLexerContanerView<CharT>;
+        using iterator = BasicLexerIterator<CharT>;
+        using const_iterator = BasicLexerConstIterator<CharT>;
+        using reverse_iterator = BasicLexerReverseIterator<CharT>;
+        using const_reverse_iterator = BasicLexerConstReverseIterator<CharT>;
+        using unchecked_iterator = BasicLexerUncheckedIterator<CharT>;
+        using string_t = std::basic_string<CharT>;
+        using string_view_t = std::basic_string_view<CharT>;
+        using source_t = std::shared_ptr<const string_t>;
+        using interner_t = BasicTokenInterner<CharT>;
+        using symbol_t = typename interner_t::symbol_t;
+
+    private:
+        friend class BasicLexerContanerBuilder<CharT>;
+        friend class BasicLexerContanerView<CharT>;
+        template <class, class, bool, bool> friend class LexerTemplateIterator;
+
+        // the text the offsets refer to, shared by copies of the storage
+        source_t _text;
+        bool _is_source;  // _text is the analysed text
+
+        // the columns are allocated from the memory resource of the storage
+        std::pmr::vector<uint64_t> _ids;
+        std::pmr::vector<size_t> _offsets;
+        std::pmr::vector<size_t> _lengths;
 
-        void _countSize();
+        // the ids of the interned texts, empty if the tokens were not interned
+        std::pmr::vector<symbol_t> _symbols;
+        std::shared_ptr<const interner_t> _interner;
+
+        std::pmr::vector<size_t> _line_ends;  // the index after the last token of a row
+        std::pmr::vector<size_t> _line_numbers;
+        std::pmr::vector<size_t> _original_offsets;
+        std::pmr::vector<size_t> _original_lengths;
+
+        // the rows built from the columns on the first use, once for all threads; the
+        // vector of rows is allocated from the memory resource, the rows themselves
+        // from the default one
+        using lines_t = std::pmr::vector<line_t>;
+        mutable std::atomic<std::shared_ptr<const lines_t>> _contaner;
+        mutable std::mutex _contaner_mutex;
+
+        const lines_t& _lines() const;
+        void _appendLines(const contaner_t& contaner);
 
     public:
         /**
          * @brief Default constructor.
          */
-        LexerContaner();
+        BasicLexerContaner();
+
+        /**
+         * @brief Creates an empty storage whose columns are allocated from the memory
+         * resource.
+         *
+         * @param resource - the memory resource, it must outlive the storage.
+         */
+        explicit BasicLexerContaner(std::pmr::memory_resource* resource);
 
         /**
-         * @brief Copy constructor.
+         * @brief Copy constructor. The columns of the copy are allocated from the
+         * default memory resource.
          *
          * @param other - another container.
          */
-        LexerContaner(const LexerContaner& other);
+        BasicLexerContaner(const BasicLexerContaner& other);
 
         /**
          * @brief Move constructor.
          *
          * @param other - another container.
          */
-        LexerContaner(LexerContaner&& other) noexcept;
+        BasicLexerContaner(BasicLexerContaner&& other) noexcept;
 
         /**
          * @brief Copies the token storage.
          *
          * @param contaner - another the token storage.
          */
-        LexerContaner(const lexer_contaner_t& contaner);
+        BasicLexerContaner(const contaner_t& contaner);
 
         /**
          * @brief Moves the token storage.
          *
          * @param contaner - another the token storage.
          */
-        LexerContaner(lexer_contaner_t&& contaner);
+        BasicLexerContaner(contaner_t&& contaner);
 
         /**
          * @brief Copy operator.
          *
          * @param other - another container.
          *
-         * @return LexerContaner&
+         * @return BasicLexerContaner&
          */
-        LexerContaner& operator=(const LexerContaner& other);
+        BasicLexerContaner& operator=(const BasicLexerContaner& other);
 
         /**
          * @brief Move operator.
          *
          * @param other - another container.
          *
-         * @return LexerContaner&
+         * @return BasicLexerContaner&
          */
-        LexerContaner& operator=(LexerContaner&& other) noexcept;
+        BasicLexerContaner& operator=(BasicLexerContaner&& other) noexcept;
 
         /**
          * @brief Copies the token storage.
          *
          * @param contaner - another the token storage.
          *
-         * @return LexerContaner&
+         * @return BasicLexerContaner&
          */
-        LexerContaner& operator=(const lexer_contaner_t& contaner);
+        BasicLexerContaner& operator=(const contaner_t& contaner);
 
         /**
          * @brief Moves the token storage.
          *
          * @param contaner - another the token storage.
          *
-         * @return LexerContaner&
+         * @return BasicLexerContaner&
          */
-        LexerContaner& operator=(lexer_contaner_t&& contaner) noexcept;
+        BasicLexerContaner& operator=(contaner_t&& contaner);
 
         /**
          * @brief Returns an iterator on the first element.
          *
-         * @return LexerIterator
+         * @return iterator
          */
-        LexerIterator begin();
+        iterator begin();
 
         /**
          * @brief Returns a constant iterator on the first element.
          *
-         * @return LexerConstIterator
+         * @return const_iterator
          */
-        LexerConstIterator begin() const;
+        const_iterator begin() const;
 
         /**
          * @brief Returns a constant iterator on the first element.
          *
-         * @return LexerConstIterator
+         * @return const_iterator
          */
-        LexerConstIterator cbegin() const;
+        const_iterator cbegin() const;
 
         /**
          * @brief Returns an iterator to the field after the last element.
          *
-         * @return LexerIterator
+         * @return iterator
          */
-        LexerIterator end();
+        iterator end();
 
         /**
          * @brief Returns a constant iterator to the field after the last element.
          *
-         * @return LexerConstIterator
+         * @return const_iterator
          */
-        LexerConstIterator end() const;
+        const_iterator end() const;
 
         /**
          * @brief Returns a constant iterator to the field after the last element.
          *
-         * @return LexerConstIterator
+         * @return const_iterator
          */
-        LexerConstIterator cend() const;
+        const_iterator cend() const;
 
         /**
          * @brief Returns a reverse iterator on the last element.
          *
-         * @return LexerReverseIterator
+         * @return reverse_iterator
          */
-        LexerReverseIterator rbegin();
+        reverse_iterator rbegin();
 
         /**
          * @brief Returns a constant reverse iterator on the last element.
          *
-         * @return LexerConstReverseIterator
+         * @return const_reverse_iterator
          */
-        LexerConstReverseIterator rbegin() const;
+        const_reverse_iterator rbegin() const;
 
         /**
          * @brief Returns a constant reverse iterator on the last element.
          *
-         * @return LexerConstReverseIterator
+         * @return const_reverse_iterator
          */
-        LexerConstReverseIterator crbegin() const;
+        const_reverse_iterator crbegin() const;
 
         /**
          * @brief Returns a reverse iterator to the field before the first element.
          *
-         * @return LexerReverseIterator
+         * @return reverse_iterator
          */
-        LexerReverseIterator rend();
+        reverse_iterator rend();
 
         /**
          * @brief Returns a constant iterator to the field before the first element.
          *
-         * @return LexerConstReverseIterator
+         * @return const_reverse_iterator
          */
-        LexerConstReverseIterator rend() const;
+        const_reverse_iterator rend() const;
 
         /**
          * @brief Returns a constant iterator to the field before the first element.
          *
-         * @return LexerConstReverseIterator
+         * @return const_reverse_iterator
          */
-        LexerConstReverseIterator crend() const;
+        const_reverse_iterator crend() const;
+
+        /**
+         * @brief Returns the tokens for hot loops: the iterators of the range do not
+         * check the bounds of the container, moving out of it is undefined.
+         *
+         * @return std::ranges::subrange<unchecked_iterator>
+         */
+        std::ranges::subrange<unchecked_iterator> unchecked() const;
 
         /**
          * @brief Returns a row of tokens.
          *
          * @param i - row index.
          *
-         * @return TokenLine&
+         * @return const line_t&
          */
-        TokenLine& getLine(size_t i);
+        const line_t& getLine(size_t i) const;
 
         /**
          * @brief Returns a row of tokens.
          *
          * @param i - row index.
          *
-         * @return const TokenLine&
+         * @return const line_t&
          */
-        const TokenLine& getLine(size_t i) const;
+        const line_t& operator[](size_t i) const;
 
         /**
-         * @brief Returns a row of tokens.
+         * @brief Returns the ids of all tokens.
+         *
+         * @return std::span<const uint64_t>
+         */
+        std::span<const uint64_t> getIds() const;
+
+        /**
+         * @brief Returns the dense ids of the interned texts of all tokens, empty if the
+         * tokens were not interned.
+         *
+         * @return std::span<const symbol_t>
+         */
+        std::span<const symbol_t> getSymbols() const;
+
+        /**
+         * @brief Returns the interner of the token texts, null if the tokens were not
+         * interned.
+         *
+         * @return std::shared_ptr<const interner_t>
+         */
+        std::shared_ptr<const interner_t> getInterner() const;
+
+        /**
+         * @brief Returns the ids of the tokens of a row.
          *
          * @param i - row index.
          *
-         * @return TokenLine&
+         * @return std::span<const uint64_t>
          */
-        TokenLine& operator[](size_t i);
+        std::span<const uint64_t> getLineIds(size_t i) const;
 
         /**
-         * @brief Returns a row of tokens.
+         * @brief Returns the text of a token.
+         *
+         * @param i - token index.
+         *
+         * @return string_view_t
+         */
+        string_view_t getTokenText(size_t i) const;
+
+        /**
+         * @brief Returns a token by its index among all tokens. The token is made from
+         * the columns, its text refers to the storage.
+         *
+         * @param i - token index.
+         *
+         * @throw std::out_of_range
+         *
+         * @return token_t
+         */
+        token_t tokenAt(size_t i) const;
+
+        /**
+         * @brief Finds the row of a token by binary search over the numbers of tokens
+         * up to the end of every row.
+         *
+         * @param i - token index.
+         *
+         * @throw std::out_of_range
+         *
+         * @return std::pair<size_t, size_t> - the row index and the index of the token
+         * in the row.
+         */
+        std::pair<size_t, size_t> locateToken(size_t i) const;
+
+        /**
+         * @brief Returns the index of the first token of a row, the number of tokens for
+         * the row after the last one.
+         *
+         * @param i - row index.
+         *
+         * @throw std::out_of_range
+         *
+         * @return size_t
+         */
+        size_t getLineStart(size_t i) const;
+
+        /**
+         * @brief Returns a view of the tokens with indexes from first to last, not
+         * including last.
+         *
+         * @param first - the index of the first token.
+         * @param last - the index after the last token.
+         *
+         * @throw std::out_of_range
+         *
+         * @return view_t
+         */
+        view_t getRange(size_t first, size_t last) const;
+
+        /**
+         * @brief Returns a view of the tokens of the rows from first to last, not
+         * including last.
+         *
+         * @param first - the index of the first row.
+         * @param last - the index after the last row.
+         *
+         * @throw std::out_of_range
+         *
+         * @return view_t
+         */
+        view_t getLineRange(size_t first, size_t last) const;
+
+        /**
+         * @brief Divides the tokens into consecutive views with nearly equal numbers of
+         * tokens, so the views can be processed by several threads at once. The sizes
+         * of the views differ by one token at most if rows may be split; otherwise
+         * every view is made of whole rows and ends at the end of the row nearest to
+         * its share, some views may be empty then.
+         *
+         * @param n - the number of views, 0 means one view per core.
+         * @param whole_lines - the rows are not split between views.
+         *
+         * @return std::vector<view_t> - n views that cover all tokens in their order.
+         */
+        std::vector<view_t> partition(size_t n, bool whole_lines = false) const;
+
+        /**
+         * @brief Returns the number of a row in the text.
          *
          * @param i - row index.
          *
-         * @return const TokenLine&
+         * @return size_t
          */
-        const TokenLine& operator[](size_t i) const;
+        size_t getLineNumber(size_t i) const;
+
+        /**
+         * @brief Returns the original row.
+         *
+         * @param i - row index.
+         *
+         * @return string_view_t
+         */
+        string_view_t getOriginal(size_t i) const;
+
+        /**
+         * @brief Returns the number of tokens with the id.
+         *
+         * @param id - the id of tokens.
+         *
+         * @return size_t
+         */
+        size_t countId(uint64_t id) const;
 
         /**
          * @brief Returns the stored number of tokens.
@@ -220,5 +438,276 @@ namespace lexer {
          * @return size_t
          */
         size_t getLinesNumber() const;
+
+        /**
+         * @brief Returns the analysed text the tokens refer to, empty if the storage
+         * keeps copies of the token texts.
+         *
+         * @return string_view_t
+         */
+        string_view_t getSource() const;
+
+        /**
+         * @brief Returns the memory resource the columns and the vector of rows are
+         * allocated from.
+         *
+         * @return std::pmr::memory_resource*
+         */
+        std::pmr::memory_resource* getMemoryResource() const;
+    };
+
+    /**
+     * @brief A range of consecutive tokens of a storage. The view keeps the indexes of
+     * its tokens only, so it is cheap to copy; the storage must outlive it.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
+     */
+    template <class CharT>
+    class BasicLexerContanerView
+        : public std::ranges::view_interface<BasicLexerContanerView<CharT>> {
+    public:
+        using contaner_t = BasicLexerContaner<CharT>;
+        using token_t = typename contaner_t::token_t;
+        using const_iterator = typename contaner_t::const_iterator;
+
+    private:
+        const contaner_t* _contaner;
+        size_t _first;
+        size_t _last;
+
+    public:
+        /**
+         * @brief Creates an empty view of no storage.
+         */
+        BasicLexerContanerView();
+
+        /**
+         * @brief Creates a view of the tokens with indexes from first to last, not
+         * including last.
+         *
+         * @param contaner - the storage.
+         * @param first - the index of the first token.
+         * @param last - the index after the last token.
+         *
+         * @throw std::out_of_range
+         */
+        BasicLexerContanerView(const contaner_t& contaner, size_t first, size_t last);
+
+        /**
+         * @brief Returns a constant iterator on the first token of the view.
+         *
+         * @return const_iterator
+         */
+        const_iterator begin() const;
+
+        /**
+         * @brief Returns a constant iterator to the field after the last token of the
+         * view.
+         *
+         * @return const_iterator
+         */
+        const_iterator end() const;
+
+        /**
+         * @brief Returns a token of the view made from the columns of the storage.
+         *
+         * @param i - the index of the token in the view.
+         *
+         * @throw std::out_of_range
+         *
+         * @return token_t
+         */
+        token_t tokenAt(size_t i) const;
+
+        /**
+         * @brief Returns the ids of the tokens of the view.
+         *
+         * @return std::span<const uint64_t>
+         */
+        std::span<const uint64_t> getIds() const;
+
+        /**
+         * @brief Returns the number of tokens of the view.
+         *
+         * @return size_t
+         */
+        size_t getSize() const;
+
+        /**
+         * @brief Returns the index of the first token of the view in the storage.
+         *
+         * @return size_t
+         */
+        size_t getBeginIndex() const;
+
+        /**
+         * @brief Returns the index after the last token of the view in the storage.
+         *
+         * @return size_t
+         */
+        size_t getEndIndex() const;
+    };
+
+    /**
+     * @brief Fills a token storage row by row.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
+     */
+    template <class CharT> class BasicLexerContanerBuilder {
+    public:
+        using contaner_t = BasicLexerContaner<CharT>;
+        using string_t = std::basic_string<CharT>;
+        using string_view_t = std::basic_string_view<CharT>;
+        using source_t = typename contaner_t::source_t;
+
+        using interner_t = typename contaner_t::interner_t;
+
+    private:
+        contaner_t _contaner;
+        string_t _text;  // the copied texts if there is no source
+        std::shared_ptr<interner_t> _interner;
+
+    public:
+        /**
+         * @brief Starts a storage whose offsets refer to the analysed text or, if the
+         * source is null, to the texts added by appendText.
+         *
+         * @param source - the analysed text.
+         * @param interner - interns the token texts if it is not null.
+         * @param resource - the columns of the storage are allocated from it, the
+         * default memory resource is used if it is null.
+         */
+        explicit BasicLexerContanerBuilder(source_t source = nullptr,
+                                           std::shared_ptr<interner_t> interner = nullptr,
+                                           std::pmr::memory_resource* resource = nullptr);
+
+        /**
+         * @brief Copies the text into the storage.
+         *
+         * @param text - a token text or an original row.
+         *
+         * @return size_t - the offset of the copy.
+         */
+        size_t appendText(string_view_t text);
+
+        /**
+         * @brief Decodes the text of another encoding straight into the storage.
+         *
+         * @tparam InputT - char, char8_t, char16_t or wchar_t.
+         *
+         * @param text - a token text or an original row.
+         *
+         * @return size_t - the offset of the copy.
+         */
+        template <class InputT>
+        size_t appendConverted(std::basic_string_view<InputT> text);
+
+        /**
+         * @brief Returns the texts copied into the storage from the offset to the end.
+         *
+         * @param offset - the offset returned by appendText or appendConverted.
+         *
+         * @return string_view_t
+         */
+        string_view_t getCopy(size_t offset) const;
+
+        /**
+         * @brief Adds a token to the current row.
+         *
+         * @param id - the id of the token.
+         * @param offset - the offset of the token text.
+         * @param length - the length of the token text.
+         */
+        void addToken(uint64_t id, size_t offset, size_t length);
+
+        /**
+         * @brief Returns "true" if the current row has no tokens.
+         *
+         * @return bool
+         */
+        bool isLineEmpty() const;
+
+        /**
+         * @brief Returns the number of added tokens.
+         *
+         * @return size_t
+         */
+        size_t getTokensNumber() const;
+
+        /**
+         * @brief Returns the number of completed rows.
+         *
+         * @return size_t
+         */
+        size_t getLinesNumber() const;
+
+        /**
+         * @brief A part of the text filled by another builder. The offsets of the part
+         * must refer to the same text, the part must not have copied texts.
+         */
+        struct Part {
+            const BasicLexerContanerBuilder* builder;
+            size_t first_token;  // the first token of the part to add
+            size_t first_line;   // the first row of the part to add
+            size_t line_shift;   // added to the row numbers of the part
+        };
+
+        /**
+         * @brief Adds the tokens and the rows of the parts in their order, the first row
+         * of a part starts with its first token. The parts are copied by several threads
+         * at once, the texts are interned in the order of the tokens.
+         *
+         * @param parts - the parts of the text.
+         * @param threads - the number of threads that copy the parts.
+         */
+        void append(std::span<const Part> parts, size_t threads = 1);
+
+        /**
+         * @brief Completes the current row if it has tokens.
+         *
+         * @param line_number - the row number.
+         * @param offset - the offset of the original row.
+         * @param length - the length of the original row.
+         */
+        void endLine(size_t line_number, size_t offset, size_t length);
+
+        /**
+         * @brief Returns the filled storage.
+         *
+         * @return contaner_t
+         */
+        contaner_t build();
     };
+
+    template <class CharT>
+    template <class InputT>
+    size_t BasicLexerContanerBuilder<CharT>::appendConverted(
+        std::basic_string_view<InputT> text) {
+        size_t offset = _text.size();
+        _text.reserve(offset + text.size());
+        for (size_t i = 0; i < text.size();) {
+            size_t size;
+            appendChar(_text, decodeChar(text.substr(i), size));
+            i += size;
+        }
+        return offset;
+    }
+
+    extern template class BasicLexerContaner<char>;
+    extern template class BasicLexerContaner<char8_t>;
+    extern template class BasicLexerContaner<char16_t>;
+    extern template class BasicLexerContaner<wchar_t>;
+
+    extern template class BasicLexerContanerView<char>;
+    extern template class BasicLexerContanerView<char8_t>;
+    extern template class BasicLexerContanerView<char16_t>;
+    extern template class BasicLexerContanerView<wchar_t>;
+
+    extern template class BasicLexerContanerBuilder<char>;
+    extern template class BasicLexerContanerBuilder<char8_t>;
+    extern template class BasicLexerContanerBuilder<char16_t>;
+    extern template class BasicLexerContanerBuilder<wchar_t>;
+
+    using LexerContaner = BasicLexerContaner<wchar_t>;
+    using LexerContanerView = BasicLexerContanerView<wchar_t>;
 }  // namespace lexer
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "lexer-contaner.h"
+#include "char-class-table.h"
+#include "simd-classifier.h"
+#include "dfa-tables.h"
+#include "dfa-scanner.h"
+#include "unicode.h"
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace lexer {
+    /**
+     * @brief A deterministic finite automaton compiled from the lexer configuration.
+     * Alphabets, individual chars, separators and combining tokens are merged into one
+     * transition table, so that every character costs a class lookup and a transition
+     * lookup. Inside a combining token the end is searched for directly.
+     */
+    class LexerDfa {
+    public:
+        using state_t = DfaTransition::state_t;
+
+    private:
+        friend class DfaScanner<LexerDfa>;
+
+        CharClassTable _char_classes;
+        size_t _classes_number;
+        std::vector<DfaTransition> _transitions;
+        state_t _first_region_state;
+        std::vector<std::wstring> _closers;
+        std::vector<size_t> _opener_sizes;
+        std::vector<DfaOpenerNode> _opener_nodes;
+        std::vector<state_t> _opener_transitions;
+
+        // UTF-8 input is classified byte by byte when the configuration is ASCII only
+        bool _ascii_only;
+        std::vector<std::string> _utf8_closers;
+        std::vector<size_t> _utf8_opener_sizes;
+
+        // UTF-16 input is classified unit by unit when the configuration has no
+        // characters out of the BMP
+        bool _bmp_only;
+        std::vector<std::u16string> _utf16_closers;
+        std::vector<size_t> _utf16_opener_sizes;
+
+        // runs of default characters and separators are skipped a block at a time
+        SimdClassifier _quiet_chars;
+        state_t _default_run_state;
+
+        size_t _threads_number;
+
+        template <typename InputT>
+        std::basic_string_view<InputT> _closer(size_t j) const {
+            if constexpr (std::is_same_v<InputT, wchar_t>) {
+                return _closers[j];
+            } else if constexpr (is_utf8_v<InputT>) {
+                return std::basic_string_view<InputT>(
+                    reinterpret_cast<const InputT*>(_utf8_closers[j].data()),
+                    _utf8_closers[j].size());
+            } else {
+                return _utf16_closers[j];
+            }
+        }
+
+        template <typename InputT>
+        size_t _openerSize(size_t j) const {
+            if constexpr (std::is_same_v<InputT, wchar_t>) {
+                return _opener_sizes[j];
+            } else if constexpr (is_utf8_v<InputT>) {
+                return _utf8_opener_sizes[j];
+            } else {
+                return _utf16_opener_sizes[j];
+            }
+        }
+
+    public:
+        /**
+         * @brief Builds an automaton that treats all characters as the same alphabet.
+         */
+        LexerDfa();
+
+        /**
+         * @brief Compiles the lexer configuration into the automaton.
+         *
+         * @param special_alphabets - a list of alphabets.
+         * @param individual_chars - a list of characters, each of which is regarded as a
+         * separate alphabet.
+         * @param combining_tokens - tokens between which all symbols are considered as a
+         * single token.
+         * @param separators - symbols used to separate words.
+         */
+        LexerDfa(const std::vector<std::wstring>& special_alphabets,
+                 const std::wstring& individual_chars,
+                 const std::vector<CombiningTokens>& combining_tokens,
+                 const std::wstring& separators);
+
+        /**
+         * @brief Returns the number of states of the automaton.
+         *
+         * @return size_t
+         */
+        size_t getStatesNumber() const;
+
+        /**
+         * @brief Runs the Aho-Corasick automaton of the initial tokens by one character.
+         * The node of a text is its longest suffix that is a prefix of an initial token,
+         * the node 0 is the empty one.
+         *
+         * @param node - the node of the text.
+         * @param c - the code point of the next character.
+         *
+         * @return state_t - the node of the text followed by the character.
+         */
+        state_t stepOpener(state_t node, wchar_t c) const {
+            return _opener_transitions[node * _classes_number + _char_classes[c]];
+        }
+
+        /**
+         * @brief Returns a node of the automaton of the initial tokens.
+         *
+         * @param node - the number of the node.
+         *
+         * @return const DfaOpenerNode&
+         */
+        const DfaOpenerNode& getOpenerNode(state_t node) const {
+            return _opener_nodes[node];
+        }
+
+        /**
+         * @brief Enables or disables skipping runs of characters with vector operations.
+         * The tokens are the same in both cases.
+         *
+         * @param enabled - "true" to enable vector operations.
+         */
+        void setSimdEnabled(bool enabled);
+
+        /**
+         * @brief Returns "true" if runs of characters are skipped with vector operations.
+         *
+         * @return bool
+         */
+        bool isSimdEnabled() const;
+
+        /**
+         * @brief Sets the number of threads that lex large contents in the encoding of
+         * the tokens. The contents are divided into chunks at line breaks, and the rows
+         * of the chunks are joined into one container; the tokens are the same as the
+         * ones made by one thread.
+         *
+         * @param threads - the number of threads, 0 means one thread per core.
+         */
+        void setThreadsNumber(size_t threads);
+
+        /**
+         * @brief Returns the number of threads that lex large contents.
+         *
+         * @return size_t
+         */
+        size_t getThreadsNumber() const;
+
+        /**
+         * @brief Starts lexical analysis of the string contents.
+         *
+         * @param str - the string contents.
+         * @param defineTokenId - a function for identifying tokens.
+         *
+         * @return LexerContaner
+         */
+        LexerContaner createTokens(const std::wstring& str,
+                                   const Token::define_id_func_t& defineTokenId) const;
+
+        /**
+         * @brief Starts lexical analysis of UTF-8 contents. The bytes are classified
+         * directly, multi-byte code points are decoded only if the configuration has
+         * characters out of ASCII.
+         *
+         * @param str - UTF-8 contents.
+         * @param defineTokenId - a function for identifying tokens.
+         *
+         * @return LexerContaner
+         */
+        LexerContaner createTokens(std::string_view str,
+                                   const Token::define_id_func_t& defineTokenId) const;
+
+        /**
+         * @brief Starts lexical analysis of UTF-8, UTF-16 or wide contents and builds
+         * tokens of the character type CharT. The input is classified in its own
+         * encoding, only the texts of the tokens are converted.
+         * Instantiated for char input of every character type, for char16_t input of
+         * char16_t tokens and for wchar_t input of wchar_t tokens.
+         *
+         * @param str - the contents.
+         * @param tokenId - identifies tokens.
+         * @param interner - interns the token texts if it is not null.
+         * @param resource - the columns of the container are allocated from it, the
+         * default memory resource is used if it is null.
+         *
+         * @return BasicLexerContaner<CharT>
+         */
+        template <class CharT, class InputT>
+        BasicLexerContaner<CharT>
+        createTokens(std::basic_string_view<InputT> str,
+                     const BasicTokenIdentifier<CharT>& tokenId,
+                     std::shared_ptr<BasicTokenInterner<CharT>> interner = nullptr,
+                     std::pmr::memory_resource* resource = nullptr) const;
+
+        /**
+         * @brief Starts lexical analysis of the text without copying it: the tokens
+         * refer to the text and the container keeps it alive.
+         * Instantiated for every character type.
+         *
+         * @param source - the text in the encoding of the tokens.
+         * @param tokenId - identifies tokens.
+         * @param interner - interns the token texts if it is not null.
+         * @param resource - the columns of the container are allocated from it, the
+         * default memory resource is used if it is null.
+         *
+         * @return BasicLexerContaner<CharT>
+         */
+        template <class CharT>
+        BasicLexerContaner<CharT> createTokenViews(
+            typename BasicLexerContaner<CharT>::source_t source,
+            const BasicTokenIdentifier<CharT>& tokenId,
+            std::shared_ptr<BasicTokenInterner<CharT>> interner = nullptr,
+            std::pmr::memory_resource* resource = nullptr) const;
+    };
+}  // namespace lexer
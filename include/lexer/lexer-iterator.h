@@ -2,30 +2,76 @@
 
 #include "token.h"
 
+#include <compare>
+#include <cstddef>
+#include <iterator>
 #include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace lexer {
-    using lexer_contaner_t = std::vector<TokenLine>;
+    template <class CharT>
+    using basic_lexer_contaner_t = std::vector<BasicTokenLine<CharT>>;
+    using lexer_contaner_t = basic_lexer_contaner_t<wchar_t>;
+
+    template <class CharT> class BasicLexerContaner;
 
     /**
      * @brief A template parent class for all types of iterators.
+     * The iterator keeps the index of its token and reads the token from the columns of
+     * the container (see BasicLexerContaner), so visiting the tokens allocates nothing
+     * and does not build the rows; the token is made on dereference and refers to the
+     * text of the container. Moving by any number of tokens and the distance between
+     * iterators are constant time. The child class is reached statically, so the
+     * iterator has no virtual functions, and it satisfies std::random_access_iterator.
      *
-     * @tparam LineIterator - an iterator that is used to track the current line.
-     * @tparam TokenIterator - an iterator that is used to track the current token.
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
      * @tparam Iterator - child class.
+     * @tparam Reverse - the tokens are visited from the last one.
+     * @tparam Checked - moving out of the container throws std::out_of_range, without
+     * the checks it is undefined.
      */
-    template <class LineIterator, class TokenIterator, class Iterator>
+    template <class CharT, class Iterator, bool Reverse = false, bool Checked = true>
     class LexerTemplateIterator {
+    public:
+        using value_type = BasicToken<CharT>;
+        using reference = value_type;
+        using difference_type = std::ptrdiff_t;
+        using iterator_concept = std::random_access_iterator_tag;
+        // the tokens are made on dereference, so the legacy category is input only
+        using iterator_category = std::input_iterator_tag;
+
+        /**
+         * @brief Keeps the token made on dereference for operator->.
+         */
+        class pointer {
+            value_type _token;
+
+        public:
+            explicit pointer(value_type&& token) : _token(std::move(token)) {}
+
+            const value_type* operator->() const {
+                return &_token;
+            }
+        };
+
     protected:
-        using contaner = lexer_contaner_t;
-        using line_it_t = LineIterator;
-        using token_it_t = TokenIterator;
+        using contaner = BasicLexerContaner<CharT>;
+        using line_t = BasicTokenLine<CharT>;
+        using token_t = BasicToken<CharT>;
+        using string_view_t = std::basic_string_view<CharT>;
 
-        line_it_t _current_line;
-        token_it_t _current_token;
+        const contaner* _contaner;
 
-        line_it_t _start_line;
-        line_it_t _end_line;
+        // the columns of the container
+        const uint64_t* _ids;
+        const size_t* _offsets;
+        const size_t* _lengths;
+        const CharT* _text;
+
+        size_t _size;   // the number of tokens
+        size_t _index;  // the number of the current token in the order of visiting
 
         /**
          * @brief Causes an exception related to going beyond the container that stores
@@ -38,76 +84,61 @@ namespace lexer {
         }
 
         /**
-         * @brief Returns an iterator to the first element of the current row.
+         * @brief Returns the index of the token in the columns.
          *
-         * @return token_it_t
-         */
-        virtual token_it_t getBegin() = 0;
-
-    public:
-        /**
-         * @brief A constructor that initializes all the fields of an iterator.
+         * @param index - the number of the token in the order of visiting.
          *
-         * @param start_line - an iterator that points to the first row of the container.
-         * @param end_line - an iterator that points to a field after the last row of a
-         * container.
-         * @param start_token - an iterator that points to the first token of the first
-         * row of the container.
+         * @return size_t
          */
-        LexerTemplateIterator(const line_it_t& start_line, const line_it_t& end_line,
-                              const token_it_t& start_token) :
-            _start_line(start_line),
-            _end_line(end_line),
-            _current_line(start_line),
-            _current_token(start_token) {}
+        size_t getColumn(size_t index) const {
+            if constexpr (Reverse) {
+                return _size - 1 - index;
+            } else {
+                return index;
+            }
+        }
 
         /**
-         * @brief Copy constructor.
+         * @brief Makes a token from the columns.
          *
-         * @param other - another iterator.
-         */
-        LexerTemplateIterator(const LexerTemplateIterator& other) :
-            _start_line(other._start_line),
-            _end_line(other._end_line),
-            _current_line(other._current_line),
-            _current_token(other._current_token) {}
-
-        /**
-         * @brief Move constructor.
+         * @param index - the number of the token in the order of visiting.
          *
-         * @param other - another iterator.
+         * @return token_t
          */
-        LexerTemplateIterator(LexerTemplateIterator&& other) noexcept :
-            _start_line(std::move(other._start_line)),
-            _end_line(std::move(other._end_line)),
-            _current_line(std::move(other._current_line)),
-            _current_token(std::move(other._current_token)) {}
+        token_t makeToken(size_t index) const {
+            size_t k = getColumn(index);
+            return token_t::makeView(_ids[k],
+                                     string_view_t(_text + _offsets[k], _lengths[k]));
+        }
 
+    public:
         /**
-         * @brief Copy operator.
-         *
-         * @param other - another iterator.
+         * @brief Creates an iterator that points to no container.
          */
-        LexerTemplateIterator& operator=(const LexerTemplateIterator& other) {
-            _current_line = other._current_line;
-            _current_token = other._current_token;
-            _start_line = other._start_line;
-            _end_line = other._end_line;
-            return *this;
-        }
+        LexerTemplateIterator() :
+            _contaner(nullptr),
+            _ids(nullptr),
+            _offsets(nullptr),
+            _lengths(nullptr),
+            _text(nullptr),
+            _size(0),
+            _index(0) {}
 
         /**
-         * @brief Move operator.
+         * @brief Points the iterator to a token of the container.
          *
-         * @param other - another iterator.
+         * @param c - the container.
+         * @param index - the number of the token in the order of visiting, the number of
+         * tokens for the end.
          */
-        LexerTemplateIterator& operator=(LexerTemplateIterator&& other) {
-            _current_line = std::move(other._current_line);
-            _current_token = std::move(other._current_token);
-            _start_line = std::move(other._start_line);
-            _end_line = std::move(other._end_line);
-            return *this;
-        }
+        LexerTemplateIterator(const contaner& c, size_t index) :
+            _contaner(&c),
+            _ids(c._ids.data()),
+            _offsets(c._offsets.data()),
+            _lengths(c._lengths.data()),
+            _text(c._text ? c._text->data() : nullptr),
+            _size(c._ids.size()),
+            _index(index) {}
 
         /**
          * @brief Moves on to the next token.
@@ -119,17 +150,12 @@ namespace lexer {
          * @return Iterator&
          */
         friend Iterator& operator++(Iterator& it) {
-            if (it._current_token !=
-                it.getBegin() + (it._current_line->tokens.size() - 1)) {
-                ++it._current_token;
-            } else if (it._current_line != it._end_line) {
-                ++it._current_line;
-                if (it._current_line != it._end_line) {
-                    it._current_token = it.getBegin();
+            if constexpr (Checked) {
+                if (it._index == it._size) {
+                    exceptionOutOfRange();
                 }
-            } else {
-                exceptionOutOfRange();
             }
+            ++it._index;
             return it;
         }
 
@@ -158,17 +184,12 @@ namespace lexer {
          * @return Iterator&
          */
         friend Iterator& operator--(Iterator& it) {
-            if (it._current_token != it.getBegin()) {
-                --it._current_token;
-            } else if (it._current_line != it._end_line) {
-                --it._current_line;
-                if (it._current_line != it._end_line) {
-                    it._current_token =
-                        it.getBegin() + (it._current_line->tokens.size() - 1);
+            if constexpr (Checked) {
+                if (it._index == 0) {
+                    exceptionOutOfRange();
                 }
-            } else {
-                exceptionOutOfRange();
             }
+            --it._index;
             return it;
         }
 
@@ -187,6 +208,41 @@ namespace lexer {
             return temp;
         }
 
+        /**
+         * @brief Moves a certain number of tokens forward or back.
+         *
+         * @param it - movable iterator.
+         * @param n - the number of movements, negative to move back.
+         *
+         * @throw std::out_of_range
+         *
+         * @return Iterator&
+         */
+        friend Iterator& operator+=(Iterator& it, difference_type n) {
+            difference_type index = static_cast<difference_type>(it._index) + n;
+            if constexpr (Checked) {
+                if (index < 0 || static_cast<size_t>(index) > it._size) {
+                    exceptionOutOfRange();
+                }
+            }
+            it._index = static_cast<size_t>(index);
+            return it;
+        }
+
+        /**
+         * @brief Moves a certain number of tokens back or forward.
+         *
+         * @param it - movable iterator.
+         * @param n - the number of movements, negative to move forward.
+         *
+         * @throw std::out_of_range
+         *
+         * @return Iterator&
+         */
+        friend Iterator& operator-=(Iterator& it, difference_type n) {
+            return it += -n;
+        }
+
         /**
          * @brief Moves a certain number of tokens forward.
          *
@@ -195,16 +251,28 @@ namespace lexer {
          *
          * @throw std::out_of_range
          *
-         * @return Iterator&
+         * @return Iterator
          */
-        friend Iterator operator+(const Iterator& start, size_t n) {
+        friend Iterator operator+(const Iterator& start, difference_type n) {
             Iterator it = start;
-            while (n--) {
-                ++it;
-            }
+            it += n;
             return it;
         }
 
+        /**
+         * @brief Moves a certain number of tokens forward.
+         *
+         * @param n - the number of movements.
+         * @param start - the initial iterator.
+         *
+         * @throw std::out_of_range
+         *
+         * @return Iterator
+         */
+        friend Iterator operator+(difference_type n, const Iterator& start) {
+            return start + n;
+        }
+
         /**
          * @brief Moves a certain number of tokens back.
          *
@@ -213,16 +281,27 @@ namespace lexer {
          *
          * @throw std::out_of_range
          *
-         * @return Iterator&
+         * @return Iterator
          */
-        friend Iterator operator-(const Iterator& start, size_t n) {
+        friend Iterator operator-(const Iterator& start, difference_type n) {
             Iterator it = start;
-            while (n--) {
-                --it;
-            }
+            it -= n;
             return it;
         }
 
+        /**
+         * @brief Returns the number of tokens between two iterators of one container.
+         *
+         * @param l - the last iterator.
+         * @param r - the first iterator.
+         *
+         * @return difference_type
+         */
+        friend difference_type operator-(const Iterator& l, const Iterator& r) {
+            return static_cast<difference_type>(l._index) -
+                   static_cast<difference_type>(r._index);
+        }
+
         /**
          * @brief Compares two iterators.
          * Returns "true" if both iterators point to the same token.
@@ -235,8 +314,7 @@ namespace lexer {
          */
         friend bool operator==(const LexerTemplateIterator& l,
                                const LexerTemplateIterator& r) {
-            return l._current_line == r._current_line &&
-                   l._current_token == r._current_token;
+            return l._index == r._index;
         }
 
         /**
@@ -255,136 +333,234 @@ namespace lexer {
         }
 
         /**
-         * @brief Returns the current token.
+         * @brief Compares the iterator with the end of its container without making
+         * the end iterator.
+         * Returns "true" if the iterator points after the last token.
+         * Else returns "false".
+         *
+         * @param it - the iterator.
+         *
+         * @return bool
+         */
+        friend bool operator==(const LexerTemplateIterator& it, std::default_sentinel_t) {
+            return it._index == it._size;
+        }
+
+        /**
+         * @brief Orders two iterators of one container by their tokens.
+         *
+         * @param l - first iterator.
+         * @param r - second iterator.
          *
-         * @return const Token&
+         * @return std::strong_ordering
          */
-        inline const Token& operator*() const {
-            return *_current_token;
+        friend std::strong_ordering operator<=>(const LexerTemplateIterator& l,
+                                                const LexerTemplateIterator& r) {
+            return l._index <=> r._index;
+        }
+
+        /**
+         * @brief Returns the current token, its text refers to the container.
+         *
+         * @return token_t
+         */
+        inline token_t operator*() const {
+            return makeToken(_index);
         }
 
         /**
          * @brief Returns a pointer to the current token.
          *
-         * @return const Token*
+         * @return pointer
+         */
+        inline pointer operator->() const {
+            return pointer(makeToken(_index));
+        }
+
+        /**
+         * @brief Returns the token a certain number of tokens away.
+         *
+         * @param n - the number of movements.
+         *
+         * @throw std::out_of_range
+         *
+         * @return token_t
          */
-        inline const Token* operator->() const {
-            return &(*_current_token);
+        token_t operator[](difference_type n) const {
+            return *(static_cast<const Iterator&>(*this) + n);
         }
 
         /**
-         * @brief Returns the current row.
+         * @brief Returns the current row, the rows of the container are built on the
+         * first call.
          *
-         * @return TokenLine
+         * @return const line_t&
          */
-        TokenLine getLine() const {
-            return *_current_line;
+        const line_t& getLine() const {
+            return _contaner->getLine(_contaner->locateToken(getColumn(_index)).first);
         }
 
         /**
          * @brief Returns the current token.
          *
-         * @return Token
+         * @return token_t
          */
-        Token getToken() const {
-            return *_current_token;
+        token_t getToken() const {
+            return makeToken(_index);
         }
     };
 
     /**
      * @brief An iterator that points to a specific token in the contaner.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
      */
-    class LexerIterator
-        : public LexerTemplateIterator<lexer_contaner_t::iterator,
-                                       TokenLine::token_contaner_t::iterator,
-                                       LexerIterator> {
+    template <class CharT>
+    class BasicLexerIterator
+        : public LexerTemplateIterator<CharT, BasicLexerIterator<CharT>> {
+        using base_t = typename BasicLexerIterator::LexerTemplateIterator;
+
     public:
+        using typename base_t::contaner;
+
         /**
-         * @brief A constructor that initializes fields within the constructor. Sets the
-         * pointers to the first element in the container.
-         *
-         * @param c - contaner.
+         * @brief Creates an iterator that points to no container.
          */
-        LexerIterator(contaner& c);
+        BasicLexerIterator() = default;
 
         /**
-         * @brief Returns an iterator to the first element of the current row.
+         * @brief Points the iterator to a token of the container, the tokens are counted
+         * from the first one.
          *
-         * @return token_it_t
+         * @param c - contaner.
+         * @param index - the index of the token, the number of tokens for the end.
          */
-        token_it_t getBegin() override;
+        BasicLexerIterator(const contaner& c, size_t index = 0);
     };
 
     /**
      * @brief A constant iterator that points to a specific token in the contaner.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
+     * @tparam Checked - moving out of the container throws std::out_of_range.
      */
-    class LexerConstIterator
-        : public LexerTemplateIterator<lexer_contaner_t::const_iterator,
-                                       TokenLine::token_contaner_t::const_iterator,
-                                       LexerConstIterator> {
+    template <class CharT, bool Checked = true>
+    class BasicLexerConstIterator
+        : public LexerTemplateIterator<CharT, BasicLexerConstIterator<CharT, Checked>,
+                                       false, Checked> {
+        using base_t = typename BasicLexerConstIterator::LexerTemplateIterator;
+
     public:
+        using typename base_t::contaner;
+
         /**
-         * @brief A constructor that initializes fields within the constructor. Sets the
-         * pointers to the first element in the container.
-         *
-         * @param c - contaner.
+         * @brief Creates an iterator that points to no container.
          */
-        LexerConstIterator(const contaner& c);
+        BasicLexerConstIterator() = default;
 
         /**
-         * @brief Returns an iterator to the first element of the current row.
+         * @brief Points the iterator to a token of the container, the tokens are counted
+         * from the first one.
          *
-         * @return token_it_t
+         * @param c - contaner.
+         * @param index - the index of the token, the number of tokens for the end.
          */
-        token_it_t getBegin() override;
+        BasicLexerConstIterator(const contaner& c, size_t index = 0);
     };
 
     /**
      * @brief A reverse iterator that points to a specific token in the contaner.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
      */
-    class LexerReverseIterator
-        : public LexerTemplateIterator<lexer_contaner_t::reverse_iterator,
-                                       TokenLine::token_contaner_t::reverse_iterator,
-                                       LexerReverseIterator> {
+    template <class CharT>
+    class BasicLexerReverseIterator
+        : public LexerTemplateIterator<CharT, BasicLexerReverseIterator<CharT>, true> {
+        using base_t = typename BasicLexerReverseIterator::LexerTemplateIterator;
+
     public:
+        using typename base_t::contaner;
+
         /**
-         * @brief A constructor that initializes fields within the constructor. Sets the
-         * pointers to the last element in the container.
-         *
-         * @param c - contaner.
+         * @brief Creates an iterator that points to no container.
          */
-        LexerReverseIterator(contaner& c);
+        BasicLexerReverseIterator() = default;
 
         /**
-         * @brief Returns an iterator to the first element of the current row.
+         * @brief Points the iterator to a token of the container, the tokens are counted
+         * from the last one.
          *
-         * @return token_it_t
+         * @param c - contaner.
+         * @param index - the index of the token, the number of tokens for the end.
          */
-        token_it_t getBegin() override;
+        BasicLexerReverseIterator(const contaner& c, size_t index = 0);
     };
 
     /**
      * @brief A constant reverse iterator that points to a specific token in the contaner.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
      */
-    class LexerConstReverseIterator
-        : public LexerTemplateIterator<
-              lexer_contaner_t::const_reverse_iterator,
-              TokenLine::token_contaner_t::const_reverse_iterator,
-              LexerConstReverseIterator> {
+    template <class CharT>
+    class BasicLexerConstReverseIterator
+        : public LexerTemplateIterator<CharT, BasicLexerConstReverseIterator<CharT>,
+                                       true> {
+        using base_t = typename BasicLexerConstReverseIterator::LexerTemplateIterator;
+
     public:
+        using typename base_t::contaner;
+
         /**
-         * @brief A constructor that initializes fields within the constructor. Sets the
-         * pointers to the last element in the container.
-         *
-         * @param c - contaner.
+         * @brief Creates an iterator that points to no container.
          */
-        LexerConstReverseIterator(const contaner& c);
+        BasicLexerConstReverseIterator() = default;
 
         /**
-         * @brief Returns an iterator to the first element of the current row.
+         * @brief Points the iterator to a token of the container, the tokens are counted
+         * from the last one.
          *
-         * @return token_it_t
+         * @param c - contaner.
+         * @param index - the index of the token, the number of tokens for the end.
          */
-        token_it_t getBegin() override;
+        BasicLexerConstReverseIterator(const contaner& c, size_t index = 0);
     };
+
+    extern template class BasicLexerIterator<char>;
+    extern template class BasicLexerIterator<char8_t>;
+    extern template class BasicLexerIterator<char16_t>;
+    extern template class BasicLexerIterator<wchar_t>;
+
+    extern template class BasicLexerConstIterator<char>;
+    extern template class BasicLexerConstIterator<char8_t>;
+    extern template class BasicLexerConstIterator<char16_t>;
+    extern template class BasicLexerConstIterator<wchar_t>;
+
+    extern template class BasicLexerConstIterator<char, false>;
+    extern template class BasicLexerConstIterator<char8_t, false>;
+    extern template class BasicLexerConstIterator<char16_t, false>;
+    extern template class BasicLexerConstIterator<wchar_t, false>;
+
+    extern template class BasicLexerReverseIterator<char>;
+    extern template class BasicLexerReverseIterator<char8_t>;
+    extern template class BasicLexerReverseIterator<char16_t>;
+    extern template class BasicLexerReverseIterator<wchar_t>;
+
+    extern template class BasicLexerConstReverseIterator<char>;
+    extern template class BasicLexerConstReverseIterator<char8_t>;
+    extern template class BasicLexerConstReverseIterator<char16_t>;
+    extern template class BasicLexerConstReverseIterator<wchar_t>;
+
+    using LexerIterator = BasicLexerIterator<wchar_t>;
+    using LexerConstIterator = BasicLexerConstIterator<wchar_t>;
+    using LexerReverseIterator = BasicLexerReverseIterator<wchar_t>;
+    using LexerConstReverseIterator = BasicLexerConstReverseIterator<wchar_t>;
+
+    /**
+     * @brief A constant iterator without the checks of the bounds for hot loops.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
+     */
+    template <class CharT>
+    using BasicLexerUncheckedIterator = BasicLexerConstIterator<CharT, false>;
+    using LexerUncheckedIterator = BasicLexerUncheckedIterator<wchar_t>;
 }  // namespace lexer
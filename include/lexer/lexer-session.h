@@ -0,0 +1,113 @@
+#pragma once
+
+#include "token.h"
+#include "lexer-dfa.h"
+#include "lexer-stream.h"
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace lexer {
+    /**
+     * @brief Divides contents that arrive in pieces into tokens, for example network
+     * packets, pipe reads or file blocks. The pieces are given to feed and the end of
+     * the contents to finish; every token is passed to the callback as soon as it is
+     * complete, even if it, a closer or an open combining token spans several pieces.
+     * Only the text that may still become a part of a token is kept. The tokens are the
+     * same as the ones of the container made by the lexer for the whole contents. The
+     * lexer must outlive the session.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
+     */
+    template <class CharT> class BasicLexerSession {
+    public:
+        using char_t = CharT;
+        using string_t = std::basic_string<CharT>;
+        using string_view_t = std::basic_string_view<CharT>;
+        using token_t = BasicToken<CharT>;
+        using stream_token_t = BasicStreamToken<CharT>;
+
+        /**
+         * @brief Receives the tokens. The text of a token is a view that is valid only
+         * during the call.
+         */
+        using token_callback_t = std::function<void(const stream_token_t&)>;
+
+    private:
+        // UTF-8 is scanned as char
+        using input_t = std::conditional_t<std::is_same_v<CharT, char8_t>, char, CharT>;
+        using cursor_t = typename DfaScanner<LexerDfa>::template Cursor<input_t>;
+
+        // passes the tokens found by a run of the automaton to the callback
+        struct _Sink {
+            BasicLexerSession* session;
+
+            void push(size_t from, size_t to, size_t line_number, size_t);
+            size_t pushBody(size_t from, size_t to, size_t line_number, size_t);
+            void endLine(size_t, size_t, size_t to);
+            static constexpr bool isFull() {
+                return false;
+            }
+        };
+
+        const LexerDfa* _dfa;
+        BasicTokenIdentifier<CharT> _token_id;
+        token_callback_t _callback;
+
+        // the contents from the first character that may be in a future token
+        string_t _buffer;
+        size_t _buffer_offset;  // the offset of _buffer in the contents
+        size_t _line_start;     // the offset of the current row in the contents
+        cursor_t _cursor;
+
+        void _run();
+
+    public:
+        /**
+         * @brief Starts a session.
+         *
+         * @param dfa - the automaton of the lexer.
+         * @param callback - receives the tokens.
+         * @param token_id - identifies tokens.
+         */
+        BasicLexerSession(const LexerDfa& dfa, token_callback_t callback,
+                          BasicTokenIdentifier<CharT> token_id = {});
+
+        /**
+         * @brief Divides the next piece of the contents into tokens. The tokens that
+         * may continue in the next pieces are kept until they are complete.
+         *
+         * @param chunk - the piece of the contents.
+         * @param n - the number of characters in the piece.
+         */
+        void feed(const CharT* chunk, size_t n);
+
+        /**
+         * @brief Divides the next piece of the contents into tokens.
+         *
+         * @param chunk - the piece of the contents.
+         */
+        void feed(string_view_t chunk);
+
+        /**
+         * @brief Ends the contents and passes the tokens that are left.
+         */
+        void finish();
+
+        /**
+         * @brief Returns "true" if the session has been finished.
+         *
+         * @return bool
+         */
+        bool isFinished() const;
+    };
+
+    extern template class BasicLexerSession<char>;
+    extern template class BasicLexerSession<char8_t>;
+    extern template class BasicLexerSession<char16_t>;
+    extern template class BasicLexerSession<wchar_t>;
+
+    using LexerSession = BasicLexerSession<wchar_t>;
+}  // namespace lexer
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "token.h"
+#include "lexer-dfa.h"
+
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace lexer {
+    /**
+     * @brief A token produced by a stream with its place in the contents.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
+     */
+    template <class CharT> struct BasicStreamToken {
+        /**
+         * @brief The token, its text is a view of the contents.
+         */
+        BasicToken<CharT> token;
+
+        /**
+         * @brief The number of the line, the same as the number of the row of
+         * BasicLexerContaner that has the token.
+         */
+        size_t line_number = 0;
+
+        /**
+         * @brief The offset of the token from the beginning of its row in characters of
+         * the type CharT.
+         */
+        size_t position = 0;
+    };
+
+    /**
+     * @brief Divides the contents into tokens on demand, one call of nextToken at a time.
+     * The automaton of the lexer is run until the next token is found, so the memory
+     * does not depend on the size of the contents. The tokens are the same as the ones
+     * of the container made by the lexer. The lexer and the contents must outlive the
+     * stream.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
+     */
+    template <class CharT> class BasicLexerStream {
+    public:
+        using char_t = CharT;
+        using string_view_t = std::basic_string_view<CharT>;
+        using token_t = BasicToken<CharT>;
+        using stream_token_t = BasicStreamToken<CharT>;
+
+    private:
+        // UTF-8 is scanned as char
+        using input_t = std::conditional_t<std::is_same_v<CharT, char8_t>, char, CharT>;
+        using cursor_t = typename DfaScanner<LexerDfa>::template Cursor<input_t>;
+
+        // receives the tokens found by one run of the automaton
+        struct _Sink {
+            BasicLexerStream* stream;
+
+            void push(size_t from, size_t to, size_t line_number, size_t line_start);
+            size_t pushBody(size_t from, size_t to, size_t line_number,
+                            size_t line_start);
+            void endLine(size_t, size_t, size_t) {}
+            bool isFull() const {
+                return !stream->_tokens.empty();
+            }
+        };
+
+        const LexerDfa* _dfa;
+        BasicTokenIdentifier<CharT> _token_id;
+        string_view_t _str;
+        cursor_t _cursor;
+
+        // the tokens found by the last run, the ones before _ready are taken
+        std::vector<stream_token_t> _tokens;
+        size_t _ready;
+
+    public:
+        /**
+         * @brief An input iterator over the tokens of a stream.
+         */
+        class Iterator {
+        private:
+            BasicLexerStream* _stream;
+            stream_token_t _token;
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = stream_token_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const stream_token_t*;
+            using reference = const stream_token_t&;
+
+            /**
+             * @brief Creates the end iterator.
+             */
+            Iterator() : _stream(nullptr) {}
+
+            /**
+             * @brief Takes the first token of the stream.
+             *
+             * @param stream - the stream of tokens.
+             */
+            Iterator(BasicLexerStream& stream) : _stream(&stream) {
+                ++*this;
+            }
+
+            reference operator*() const {
+                return _token;
+            }
+
+            pointer operator->() const {
+                return &_token;
+            }
+
+            Iterator& operator++() {
+                if (!_stream->nextToken(_token)) {
+                    _stream = nullptr;
+                }
+                return *this;
+            }
+
+            void operator++(int) {
+                ++*this;
+            }
+
+            friend bool operator==(const Iterator& left, const Iterator& right) {
+                return left._stream == right._stream;
+            }
+
+            friend bool operator!=(const Iterator& left, const Iterator& right) {
+                return !(left == right);
+            }
+        };
+
+        /**
+         * @brief Prepares the stream of tokens of the contents.
+         *
+         * @param dfa - the automaton of the lexer.
+         * @param str - the contents.
+         * @param token_id - identifies tokens.
+         */
+        BasicLexerStream(const LexerDfa& dfa, string_view_t str,
+                         BasicTokenIdentifier<CharT> token_id = {});
+
+        /**
+         * @brief Takes the next token of the contents.
+         *
+         * @param token - receives the token.
+         *
+         * @return bool - "false" if the contents have no more tokens.
+         */
+        bool nextToken(stream_token_t& token);
+
+        /**
+         * @brief Returns "true" if the contents have been read to the end and all
+         * tokens have been taken.
+         *
+         * @return bool
+         */
+        bool isFinished() const;
+
+        /**
+         * @brief Returns an iterator that takes the tokens of the stream.
+         *
+         * @return Iterator
+         */
+        Iterator begin();
+
+        /**
+         * @brief Returns the end iterator.
+         *
+         * @return Iterator
+         */
+        Iterator end();
+    };
+
+    extern template class BasicLexerStream<char>;
+    extern template class BasicLexerStream<char8_t>;
+    extern template class BasicLexerStream<char16_t>;
+    extern template class BasicLexerStream<wchar_t>;
+
+    using LexerStream = BasicLexerStream<wchar_t>;
+    using StreamToken = BasicStreamToken<wchar_t>;
+}  // namespace lexer
@@ -1,49 +1,137 @@
 #pragma once
 
 #include "lexer-contaner.h"
+#include "char-class-table.h"
+#include "lexer-dfa.h"
+#include "lexer-stream.h"
+#include "lexer-session.h"
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <span>
+#include <filesystem>
 #include <fstream>
+#include <memory_resource>
+#include <type_traits>
 
 namespace lexer {
+    /**
+     * @brief The ways to run the lexical analysis.
+     */
+    enum class LexerEngine {
+        /**
+         * @brief Processes characters one by one through the lexer methods. It is the
+         * reference for the other engine and uses neither vector operations nor
+         * several threads.
+         */
+        Classic,
+
+        /**
+         * @brief Runs the automaton compiled from the lexer configuration. Runs of
+         * default characters and separators are skipped with vector operations when the
+         * processor has AVX2, and a large text may be lexed by several threads (see
+         * BasicLexer::setThreadsNumber).
+         */
+        Dfa
+    };
+
     /**
      * @brief It is used to divide the contents of a file into tokens.
+     * The configuration and the tokens are texts with characters of the type CharT:
+     * UTF-8 for char and char8_t, UTF-16 for char16_t and wide characters for wchar_t.
+     * The functions that make tokens are const and may be called by several threads
+     * at once while the lexer is not changed.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
      */
-    class Lexer {
+    template <class CharT> class BasicLexer {
+    public:
+        using char_t = CharT;
+        using string_t = std::basic_string<CharT>;
+        using string_view_t = std::basic_string_view<CharT>;
+        using token_t = BasicToken<CharT>;
+        using token_line_t = BasicTokenLine<CharT>;
+        using combining_tokens_t = BasicCombiningTokens<CharT>;
+        using contaner_t = BasicLexerContaner<CharT>;
+        using define_id_func_t = typename token_t::define_id_func_t;
+        using interner_t = BasicTokenInterner<CharT>;
+        using stream_t = BasicLexerStream<CharT>;
+        using session_t = BasicLexerSession<CharT>;
+        using Engine = LexerEngine;
+
     private:
         struct _CurrentStats {
             size_t line_number;
-            lexer_contaner_t token_lines;
-            std::wstring token_name;
-            TokenLine token_line;
-            wchar_t c;
-            std::wstring::const_iterator char_it;
-            std::wstring::const_iterator end_it;
+            size_t region_lines;
+            BasicLexerContanerBuilder<CharT> tokens;
+            string_t token_name;
+            uint64_t token_id;  // the id of token_name if _token_id is incremental
+            wchar_t c;       // the code point of the current character
+            wchar_t last_c;  // the code point of the last character of token_name
+            // the longest suffix of token_name that is a prefix of an initial token
+            LexerDfa::state_t opener_node;
+            bool opener_whole;  // the suffix is the whole token_name
+            typename string_view_t::const_iterator begin_it;     // of the contents
+            typename string_view_t::const_iterator line_start;   // of the current row
+            typename string_view_t::const_iterator token_start;  // of token_name
+            typename string_view_t::const_iterator char_begin;
+            typename string_view_t::const_iterator char_it;
+            typename string_view_t::const_iterator end_it;
         };
 
-        std::vector<std::wstring> _special_alphabets;
-        std::wstring _individual_chars;
-        std::vector<CombiningTokens> _combining_tokens;
-        std::wstring _separators;
+        enum _CharClass : CharClassTable::class_t {
+            _DEFAULT_CHAR = 0,
+            _SEPARATOR_CHAR,
+            _INDIVIDUAL_CHAR,
+            _ALPHABET_CHAR  // the first group of the special alphabets, the g-th
+                            // one is _ALPHABET_CHAR + g
+        };
 
-        Token::define_id_func_t _defineTokenId;
+        std::vector<string_t> _special_alphabets;
+        string_t _individual_chars;
+        std::vector<combining_tokens_t> _combining_tokens;
+        string_t _separators;
 
-        std::vector<CombiningTokens>::iterator _isCombiningToken(const Token& token);
-        bool _isCharFromSpecialAlhpabet(wchar_t c) const;
-        bool _isDifferentAlphabets(wchar_t a, wchar_t b) const;
-        bool
-        _isCloseToken(_CurrentStats& current_stats,
-                      std::vector<lexer::CombiningTokens>::iterator& close_token) const;
+        BasicTokenIdentifier<CharT> _token_id;
+
+        CharClassTable _char_classes;
+        AlphabetGroups _alphabet_groups;
+        LexerDfa _dfa;
+        Engine _engine;
+        bool _zero_copy;
+        std::shared_ptr<interner_t> _interner;
 
-        void _pushToken(_CurrentStats& current_stats);
-        void _pushText(_CurrentStats& current_stats,
-                       std::vector<lexer::CombiningTokens>::iterator& close_token);
+        void _compile();
 
-        void _addIndividualChars(_CurrentStats& current_stats);
-        void _addSpecialAlphabet(_CurrentStats& current_stats);
+        typename std::vector<combining_tokens_t>::const_iterator
+        _findCombiningToken(const _CurrentStats& current_stats, bool only_glued) const;
+        bool _continuesOpener(const _CurrentStats& current_stats) const;
+        bool _isDifferentAlphabets(wchar_t a, wchar_t b) const;
 
-        void _nextLine(_CurrentStats& current_stats);
+        void _appendChar(_CurrentStats& current_stats) const;
+        void _pushTokenText(_CurrentStats& current_stats, string_view_t text) const;
+        void _pushTokenText(_CurrentStats& current_stats, string_view_t text,
+                            uint64_t id) const;
+        void _pushTokenName(_CurrentStats& current_stats) const;
+        bool _pushToken(_CurrentStats& current_stats, bool reread_char) const;
+        bool _pushGluedOpener(_CurrentStats& current_stats) const;
+        void _pushText(
+            _CurrentStats& current_stats,
+            typename std::vector<combining_tokens_t>::const_iterator close_token) const;
+
+        void _addIndividualChars(_CurrentStats& current_stats) const;
+        void _addSpecialAlphabet(_CurrentStats& current_stats) const;
+
+        void _nextLine(_CurrentStats& current_stats) const;
+
+        contaner_t _createTokens(string_view_t str,
+                                 typename contaner_t::source_t source = nullptr,
+                                 std::pmr::memory_resource* resource = nullptr) const;
+        contaner_t _createTokenViews(string_t&& str,
+                                     std::pmr::memory_resource* resource) const;
+        contaner_t _createTokensOfView(string_view_t str,
+                                       std::pmr::memory_resource* resource) const;
 
     public:
         /**
@@ -57,165 +145,350 @@ namespace lexer {
          * @param separators - symbols used to separate words.
          * @param defineTokenIdFunc - a function for identifying tokens
          * (calculates the hash of the token by default).
+         * @param engine - the way to run the lexical analysis.
          */
-        Lexer(const std::vector<std::wstring>& special_alphabets,
-              const std::wstring& individual_chars,
-              const std::vector<CombiningTokens>& combining_tokens,
-              const std::wstring& separators,
-              Token::define_id_func_t defineTokenIdFunc = lexer::defineTokenId<uint64_t>);
+        BasicLexer(const std::vector<string_t>& special_alphabets,
+                   const string_t& individual_chars,
+                   const std::vector<combining_tokens_t>& combining_tokens,
+                   const string_t& separators,
+                   define_id_func_t defineTokenIdFunc =
+                       lexer::defineTokenId<uint64_t, CharT>,
+                   Engine engine = Engine::Classic);
 
         /**
          * @brief Copy constructor.
          *
          * @param other - another lexer.
          */
-        Lexer(const Lexer& other);
+        BasicLexer(const BasicLexer& other);
 
         /**
          * @brief Move constructor.
          *
          * @param other - another lexer.
          */
-        Lexer(Lexer&& other) noexcept;
+        BasicLexer(BasicLexer&& other) noexcept;
 
         /**
          * @brief Copy operator.
          *
          * @param right - another lexer.
          */
-        Lexer& operator=(const Lexer& right);
+        BasicLexer& operator=(const BasicLexer& right);
 
         /**
          * @brief Move operator.
          *
          * @param right - another lexer.
          */
-        Lexer& operator=(Lexer&& right) noexcept;
+        BasicLexer& operator=(BasicLexer&& right) noexcept;
 
         /**
          * @brief Sets new special alphabets.
          *
          * @param new_special_alphabets - a new special alphabets.
          */
-        void setSpecialAlphabets(const std::vector<std::wstring>& new_special_alphabets);
+        void setSpecialAlphabets(const std::vector<string_t>& new_special_alphabets);
 
         /**
          * @brief Adds new special alphabet.
          *
          * @param new_special_alphabet - a new special alphabet.
          */
-        void addSpecialAlphabet(const std::wstring& new_special_alphabet);
+        void addSpecialAlphabet(const string_t& new_special_alphabet);
 
         /**
          * @brief Sets new special alphabets.
          *
          * @param new_special_alphabets - a new special alphabets.
          */
-        void
-        setSpecialAlphabets(std::vector<std::wstring>&& new_special_alphabets) noexcept;
+        void setSpecialAlphabets(std::vector<string_t>&& new_special_alphabets);
 
         /**
          * @brief Adds new special alphabet.
          *
          * @param new_special_alphabet - a new special alphabet.
          */
-        void addSpecialAlphabet(std::wstring&& new_special_alphabet) noexcept;
+        void addSpecialAlphabet(string_t&& new_special_alphabet);
 
         /**
          * @brief Sets new individual chars.
          *
          * @param new_individual_chars - a new individual chars.
          */
-        void setIndividualChars(const std::wstring& new_individual_chars);
+        void setIndividualChars(const string_t& new_individual_chars);
 
         /**
          * @brief Adds new individual char.
          *
          * @param new_individual_char - a new individual char.
          */
-        void addIndividualChar(const wchar_t& new_individual_char);
+        void addIndividualChar(const char_t& new_individual_char);
 
         /**
          * @brief Sets new individual chars.
          *
          * @param new_individual_chars - a new individual chars.
          */
-        void setIndividualChars(std::wstring&& new_individual_chars) noexcept;
+        void setIndividualChars(string_t&& new_individual_chars);
 
         /**
          * @brief Adds new individual char.
          *
          * @param new_individual_char - a new individual char.
          */
-        void addIndividualChar(wchar_t&& new_individual_char) noexcept;
+        void addIndividualChar(char_t&& new_individual_char);
 
         /**
          * @brief Sets combining tokens.
          *
          * @param new_combining_tokens - a new combining tokens.
          */
-        void setCombiningTokens(const std::vector<CombiningTokens>& new_combining_tokens);
+        void
+        setCombiningTokens(const std::vector<combining_tokens_t>& new_combining_tokens);
 
         /**
          * @brief Adds combining tokens.
          *
          * @param new_combining_token - a new combining token.
          */
-        void addCombiningToken(const CombiningTokens& new_combining_token);
+        void addCombiningToken(const combining_tokens_t& new_combining_token);
 
         /**
          * @brief Sets combining tokens.
          *
          * @param new_combining_tokens - a new combining tokens.
          */
-        void
-        setCombiningTokens(std::vector<CombiningTokens>&& new_combining_tokens) noexcept;
+        void setCombiningTokens(std::vector<combining_tokens_t>&& new_combining_tokens);
 
         /**
          * @brief Adds combining tokens.
          *
          * @param new_combining_token - a new combining token.
          */
-        void addCombiningToken(CombiningTokens&& new_combining_token) noexcept;
+        void addCombiningToken(combining_tokens_t&& new_combining_token);
+
+        /**
+         * @brief Sets the way to run the lexical analysis. Both engines make the same
+         * tokens. Only Engine::Dfa skips runs of characters with vector operations and
+         * divides a large text between several threads; Engine::Classic, the default,
+         * reads every character on the calling thread.
+         *
+         * @param new_engine - a new engine.
+         */
+        void setEngine(Engine new_engine);
+
+        /**
+         * @brief Returns the way to run the lexical analysis.
+         *
+         * @return Engine
+         */
+        Engine getEngine() const;
+
+        /**
+         * @brief Sets whether the container of tokens keeps the analysed text instead of
+         * copies of the token texts when the text is in another encoding than the
+         * tokens. The text is converted to the character type of the tokens first then.
+         * Text in the encoding of the tokens is always kept by the container.
+         *
+         * @param zero_copy - "true" to keep the analysed text.
+         */
+        void setZeroCopy(bool zero_copy);
+
+        /**
+         * @brief Returns "true" if the container of tokens keeps the analysed text in
+         * any encoding.
+         *
+         * @return bool
+         */
+        bool isZeroCopy() const;
+
+        /**
+         * @brief Sets the number of threads that lex one large text. The text is divided
+         * into chunks at line breaks that are lexed at once, a chunk that starts inside
+         * a combining token is corrected when the end of the previous chunk is known.
+         * It is used by the Dfa engine when the text is in the encoding of the tokens,
+         * the tokens are the same as the ones made by one thread. The function for
+         * identifying tokens is called by several threads then.
+         *
+         * @param threads - the number of threads, 0 means one thread per core.
+         */
+        void setThreadsNumber(size_t threads);
+
+        /**
+         * @brief Returns the number of threads that lex one large text.
+         *
+         * @return size_t
+         */
+        size_t getThreadsNumber() const;
+
+        /**
+         * @brief Sets the interner of the token texts. The containers of tokens keep the
+         * dense ids of the texts, every distinct text is stored once by the interner.
+         * Copies of the lexer share the interner. Texts that are already interned are
+         * found without a lock, so the threads that lex at once wait for each other
+         * only to store new texts.
+         *
+         * @param interner - an interner, null to keep the texts in the containers.
+         */
+        void setInterner(std::shared_ptr<interner_t> interner);
+
+        /**
+         * @brief Returns the interner of the token texts.
+         *
+         * @return std::shared_ptr<interner_t>
+         */
+        std::shared_ptr<interner_t> getInterner() const;
 
         /**
          * @brief Returns a special alphabets.
          *
-         * @return std::vector<std::wstring>
+         * @return std::vector<string_t>
          */
-        std::vector<std::wstring> getSpecialAlphabets() const;
+        std::vector<string_t> getSpecialAlphabets() const;
 
         /**
          * @brief Returns a individual chars.
          *
-         * @return std::wstring
+         * @return string_t
          */
-        std::wstring getIndividualChars() const;
+        string_t getIndividualChars() const;
 
         /**
          * @brief Return a combining tokens.
          */
-        std::vector<CombiningTokens> getCombiningTokens() const;
+        std::vector<combining_tokens_t> getCombiningTokens() const;
 
         /**
          * @brief Opens the file and starts lexical analysis of the file contents.
+         * The file is read as UTF-8. A regular file is mapped to memory and lexed
+         * straight from the mapped pages, other files are read until their end.
          *
          * @param file_name - the file contents name.
+         * @param resource - the columns of the container are allocated from it, the
+         * default memory resource is used if it is null. It must outlive the container.
          */
-        LexerContaner createTokens(const char* file_name);
+        contaner_t createTokens(const char* file_name,
+                                std::pmr::memory_resource* resource = nullptr) const;
 
         /**
          * @brief Starts lexical analysis of the file contents.
          *
          * @param file - the file contents.
+         * @param resource - the columns of the container are allocated from it, the
+         * default memory resource is used if it is null. It must outlive the container.
+         */
+        contaner_t createTokens(std::wifstream& file,
+                                std::pmr::memory_resource* resource = nullptr) const
+            requires std::is_same_v<CharT, wchar_t>;
+
+        /**
+         * @brief Reads the files in the background and divides each of them into tokens
+         * as soon as its contents have been read, so reading overlaps lexical analysis.
+         * The files are read as UTF-8 through io_uring where it is available
+         * (FileBatchReader), the largest files first, and every thread takes the next
+         * file that has been read. If a file cannot be read, the other files are still
+         * processed and then the first error is thrown.
+         *
+         * @param file_names - the names of the files.
+         * @param threads - the number of threads that make the tokens, 0 means one
+         * thread per core.
+         *
+         * @return std::vector<contaner_t> - the tokens of the files in the order of
+         * their names.
+         */
+        std::vector<contaner_t>
+        createTokensBatch(std::span<const std::filesystem::path> file_names,
+                          size_t threads = 0) const;
+
+        /**
+         * @brief Divides each of the contents into tokens on a WorkStealingPool, the
+         * largest contents are started first. If lexical analysis of some contents
+         * fails, the other contents are still processed and then the first error is
+         * thrown.
+         *
+         * @param inputs - the contents, they are copied into the containers.
+         * @param threads - the number of threads, 0 means one thread per core.
+         *
+         * @return std::vector<contaner_t> - the tokens of the contents in their order.
+         */
+        std::vector<contaner_t> createTokensBatch(std::span<const string_view_t> inputs,
+                                                  size_t threads = 0) const;
+
+        /**
+         * @brief Starts lexical analysis of the string contents. The vector operations
+         * and the threads of the lexer are used only by Engine::Dfa (see setEngine).
+         *
+         * @param str - the string contents.
+         * @param resource - the columns of the container are allocated from it, the
+         * default memory resource is used if it is null. It must outlive the container.
          */
-        LexerContaner createTokens(std::wifstream& file);
+        contaner_t createTokens(const string_t& str,
+                                std::pmr::memory_resource* resource = nullptr) const;
 
         /**
-         * @brief Starts lexical analysis of the string contents.
+         * @brief Starts lexical analysis of the string contents. The string is moved to
+         * the container of tokens.
          *
          * @param str - the string contents.
+         * @param resource - the columns of the container are allocated from it, the
+         * default memory resource is used if it is null. It must outlive the container.
          */
-        LexerContaner createTokens(const std::wstring& str);
+        contaner_t createTokens(string_t&& str,
+                                std::pmr::memory_resource* resource = nullptr) const;
+
+        /**
+         * @brief Starts lexical analysis of UTF-8 contents without converting them to
+         * wide characters first.
+         *
+         * @param str - UTF-8 contents.
+         * @param resource - the columns of the container are allocated from it, the
+         * default memory resource is used if it is null. It must outlive the container.
+         */
+        contaner_t createTokens(std::string_view str,
+                                std::pmr::memory_resource* resource = nullptr) const
+            requires(!std::is_same_v<CharT, char>);
+
+        /**
+         * @brief Starts lexical analysis of UTF-8 contents without converting them to
+         * wide characters first.
+         *
+         * @param str - UTF-8 contents.
+         * @param resource - the columns of the container are allocated from it, the
+         * default memory resource is used if it is null. It must outlive the container.
+         */
+        contaner_t createTokens(std::u8string_view str,
+                                std::pmr::memory_resource* resource = nullptr) const
+            requires(!std::is_same_v<CharT, char8_t>);
+
+        /**
+         * @brief Creates a stream that divides the contents into tokens on demand
+         * instead of building the container. The stream runs the automaton of the lexer
+         * whatever the engine is, the texts of the tokens are views of the contents. The
+         * lexer and the contents must outlive the stream.
+         *
+         * @param str - the string contents.
+         *
+         * @return stream_t
+         */
+        stream_t createStream(string_view_t str) const;
+
+        /**
+         * @brief Creates a session that divides contents arriving in pieces into tokens
+         * and passes them to the callback. The session runs the automaton of the lexer
+         * whatever the engine is. The lexer must outlive the session.
+         *
+         * @param callback - receives the tokens.
+         *
+         * @return session_t
+         */
+        session_t createSession(typename session_t::token_callback_t callback) const;
     };
+
+    extern template class BasicLexer<char>;
+    extern template class BasicLexer<char8_t>;
+    extern template class BasicLexer<char16_t>;
+    extern template class BasicLexer<wchar_t>;
+
+    using Lexer = BasicLexer<wchar_t>;
 }  // namespace lexer
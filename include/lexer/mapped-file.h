@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace lexer {
+    /**
+     * @brief The contents of a file opened for reading.
+     * A regular file is mapped to memory read-only with the advice of sequential
+     * access, so the contents are read straight from the mapped pages. Other files,
+     * for example pipes, and systems without mmap are read into a buffer.
+     */
+    class MappedFile {
+    private:
+        const char* _data;
+        size_t _size;
+        bool _mapped;
+        std::string _buffer;  // the contents if the file is not mapped
+
+        void _unmap();
+
+    public:
+        /**
+         * @brief Opens the file and maps or reads its contents.
+         *
+         * @param file_name - the name of the file.
+         */
+        MappedFile(const char* file_name);
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& right) noexcept;
+
+        ~MappedFile();
+
+        /**
+         * @brief Returns the contents of the file, they are valid while the object is
+         * alive.
+         *
+         * @return std::string_view
+         */
+        std::string_view getContents() const;
+
+        /**
+         * @brief Returns "true" if the contents are mapped to memory.
+         *
+         * @return bool
+         */
+        bool isMapped() const;
+    };
+}  // namespace lexer
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace lexer {
+    /**
+     * @brief Builds bitmaps of characters from small ASCII sets, a block of characters
+     * at a time.
+     * When the processor supports AVX2, 32 characters are classified with a few vector
+     * operations, otherwise the characters are checked one by one.
+     */
+    class SimdClassifier {
+    public:
+        /**
+         * @brief The number of characters described by one bitmap.
+         */
+        static constexpr size_t BLOCK_SIZE = 64;
+
+        /**
+         * @brief The number of character sets.
+         */
+        static constexpr size_t SETS_NUMBER = 2;
+
+        using masks_t = std::array<uint64_t, SETS_NUMBER>;
+
+    private:
+        // bit h of _low_nibbles[s][l] is set if the character (h << 4 | l) is in the
+        // set s
+        std::array<std::array<uint8_t, 16>, SETS_NUMBER> _low_nibbles;
+        bool _enabled;
+
+        template <typename CharT>
+        masks_t _classifyScalar(const CharT* block, size_t n) const;
+        template <typename CharT>
+        masks_t _classifyVector(const CharT* block) const;
+        template <typename CharT>
+        masks_t _classify(const CharT* block, size_t n) const;
+
+    public:
+        /**
+         * @brief Creates empty sets. Vector operations are enabled if they are supported.
+         */
+        SimdClassifier();
+
+        /**
+         * @brief Adds the character to the set. Characters out of ASCII are ignored.
+         *
+         * @param set - the set number.
+         * @param c - a character.
+         */
+        void addChar(size_t set, wchar_t c);
+
+        /**
+         * @brief Returns "true" if the character is in the set.
+         *
+         * @param set - the set number.
+         * @param c - a character.
+         *
+         * @return bool
+         */
+        bool contains(size_t set, wchar_t c) const;
+
+        /**
+         * @brief Enables or disables vector operations. They stay disabled if the
+         * processor does not support them.
+         *
+         * @param enabled - "true" to enable vector operations.
+         */
+        void setEnabled(bool enabled);
+
+        /**
+         * @brief Returns "true" if vector operations are used.
+         *
+         * @return bool
+         */
+        bool isEnabled() const;
+
+        /**
+         * @brief Returns "true" if the processor supports vector operations.
+         *
+         * @return bool
+         */
+        static bool isSupported();
+
+        /**
+         * @brief Builds bitmaps of the block: bit i of the mask s is set if block[i] is
+         * in the set s.
+         *
+         * @param block - the first character of the block.
+         * @param n - the number of characters in the block, not more than BLOCK_SIZE.
+         *
+         * @return masks_t
+         */
+        masks_t classify(const wchar_t* block, size_t n) const;
+
+        /**
+         * @brief Builds bitmaps of a block of UTF-8 bytes. Bytes above ASCII are never in
+         * the sets.
+         *
+         * @param block - the first byte of the block.
+         * @param n - the number of bytes in the block, not more than BLOCK_SIZE.
+         *
+         * @return masks_t
+         */
+        masks_t classify(const char* block, size_t n) const;
+
+        /**
+         * @brief Builds bitmaps of a block of UTF-16 units.
+         *
+         * @param block - the first unit of the block.
+         * @param n - the number of units in the block, not more than BLOCK_SIZE.
+         *
+         * @return masks_t
+         */
+        masks_t classify(const char16_t* block, size_t n) const;
+    };
+}  // namespace lexer
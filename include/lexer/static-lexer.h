@@ -0,0 +1,266 @@
+#pragma once
+
+#include "lexer-contaner.h"
+#include "char-class-table.h"
+#include "dfa-tables.h"
+#include "dfa-scanner.h"
+#include "simd-classifier.h"
+#include "unicode.h"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace lexer {
+    /**
+     * @brief A lexer whose configuration is known at compile time.
+     * The automaton is compiled by the compiler, so that the lexer has no constructor
+     * work and no heap-allocated configuration, and the scan loop is instantiated for
+     * the tables of this configuration. The tokens are the same as the tokens of Lexer
+     * with the automaton engine and ids calculated by defineTokenId, so keyword ids are
+     * constant expressions and can be used in switch statements.
+     *
+     * Spec declares the configuration as static constexpr members:
+     * special_alphabets - a range of std::wstring_view,
+     * individual_chars - std::wstring_view,
+     * combining_tokens - a range of std::pair<std::wstring_view, std::wstring_view>,
+     * separators - std::wstring_view.
+     *
+     * @tparam Spec - the type with the configuration.
+     */
+    template <class Spec> class StaticLexer {
+    public:
+        using state_t = DfaTransition::state_t;
+        using class_t = CharClassTable::class_t;
+
+    private:
+        friend class DfaScanner<StaticLexer>;
+
+        static constexpr DfaTables _build() {
+            return DfaBuilder::build(Spec::special_alphabets, Spec::individual_chars,
+                                     Spec::combining_tokens, Spec::separators);
+        }
+
+        struct _Sizes {
+            size_t other_chars;  // characters out of the flat array
+            size_t transitions;
+            size_t combining_tokens;
+            size_t closer_chars;
+            size_t utf8_closer_chars;
+            size_t utf16_closer_chars;
+        };
+
+        static constexpr _Sizes _SIZES = [] {
+            DfaTables tables = _build();
+            auto chars = [](const auto& closers) {
+                size_t size = 0;
+                for (const auto& closer : closers) {
+                    size += closer.size();
+                }
+                return size;
+            };
+            return _Sizes {
+                static_cast<size_t>(std::count_if(
+                    tables.char_classes.begin(), tables.char_classes.end(),
+                    [](const auto& entry) {
+                        return static_cast<std::make_unsigned_t<wchar_t>>(entry.first) >=
+                               CharClassTable::FLAT_SIZE;
+                    })),
+                tables.transitions.size(),
+                tables.closers.size(),
+                chars(tables.closers),
+                chars(tables.utf8_closers),
+                chars(tables.utf16_closers)
+            };
+        }();
+
+        // characters below FLAT_SIZE are classified by a flat array, the others by a
+        // binary search
+        struct _CharClasses {
+            std::array<class_t, CharClassTable::FLAT_SIZE> flat;
+            std::array<std::pair<wchar_t, class_t>, _SIZES.other_chars> other;
+
+            constexpr class_t operator[](wchar_t c) const {
+                if (static_cast<std::make_unsigned_t<wchar_t>>(c) <
+                    CharClassTable::FLAT_SIZE) {
+                    return flat[static_cast<std::make_unsigned_t<wchar_t>>(c)];
+                }
+                auto it = std::lower_bound(
+                    other.begin(), other.end(), c,
+                    [](const std::pair<wchar_t, class_t>& entry, wchar_t other_c) {
+                        return entry.first < other_c;
+                    });
+                return it != other.end() && it->first == c ? it->second : 0;
+            }
+        };
+
+        // the closers of one encoding are stored one after another
+        template <class CharT, size_t CHARS_NUMBER> struct _Closers {
+            std::array<CharT, CHARS_NUMBER> chars;
+            std::array<size_t, _SIZES.combining_tokens + 1> offsets;
+            std::array<size_t, _SIZES.combining_tokens> opener_sizes;
+
+            template <class Strings, class Sizes>
+            constexpr _Closers(const Strings& closers, const Sizes& sizes) :
+                chars {}, offsets {}, opener_sizes {} {
+                for (size_t j = 0; j < closers.size(); ++j) {
+                    std::copy(closers[j].begin(), closers[j].end(),
+                              chars.begin() + offsets[j]);
+                    offsets[j + 1] = offsets[j] + closers[j].size();
+                    opener_sizes[j] = sizes[j];
+                }
+            }
+
+            constexpr std::basic_string_view<CharT> get(size_t j) const {
+                return std::basic_string_view<CharT>(chars.data() + offsets[j],
+                                                     offsets[j + 1] - offsets[j]);
+            }
+        };
+
+        struct _Tables {
+            _CharClasses char_classes;
+            std::array<DfaTransition, _SIZES.transitions> transitions;
+            size_t classes_number;
+            state_t first_region_state;
+            state_t default_run_state;
+            bool ascii_only;
+            bool bmp_only;
+            _Closers<wchar_t, _SIZES.closer_chars> closers;
+            _Closers<char, _SIZES.utf8_closer_chars> utf8_closers;
+            _Closers<char16_t, _SIZES.utf16_closer_chars> utf16_closers;
+        };
+
+        static constexpr _Tables _TABLES = [] {
+            DfaTables tables = _build();
+            _CharClasses char_classes {};
+            size_t other = 0;
+            for (const auto& [c, char_class] : tables.char_classes) {
+                if (static_cast<std::make_unsigned_t<wchar_t>>(c) <
+                    CharClassTable::FLAT_SIZE) {
+                    char_classes.flat[static_cast<std::make_unsigned_t<wchar_t>>(c)] =
+                        char_class;
+                } else {
+                    char_classes.other[other++] = { c, char_class };
+                }
+            }
+            std::array<DfaTransition, _SIZES.transitions> transitions {};
+            std::copy(tables.transitions.begin(), tables.transitions.end(),
+                      transitions.begin());
+            return _Tables {
+                char_classes,
+                transitions,
+                tables.classes_number,
+                tables.first_region_state,
+                tables.default_run_state,
+                tables.ascii_only,
+                tables.bmp_only,
+                { tables.closers, tables.opener_sizes },
+                { tables.utf8_closers, tables.utf8_opener_sizes },
+                { tables.utf16_closers, tables.utf16_opener_sizes }
+            };
+        }();
+
+        static constexpr const _CharClasses& _char_classes = _TABLES.char_classes;
+        static constexpr const auto& _transitions = _TABLES.transitions;
+        static constexpr size_t _classes_number = _TABLES.classes_number;
+        static constexpr state_t _first_region_state = _TABLES.first_region_state;
+        static constexpr state_t _default_run_state = _TABLES.default_run_state;
+        static constexpr bool _ascii_only = _TABLES.ascii_only;
+        static constexpr bool _bmp_only = _TABLES.bmp_only;
+
+        // vector operations are checked at run time
+        inline static const SimdClassifier _quiet_chars =
+            DfaScanner<StaticLexer>::quietChars(_TABLES.char_classes);
+
+        template <typename InputT>
+        static constexpr std::basic_string_view<InputT> _closer(size_t j) {
+            if constexpr (std::is_same_v<InputT, wchar_t>) {
+                return _TABLES.closers.get(j);
+            } else if constexpr (is_utf8_v<InputT>) {
+                return _TABLES.utf8_closers.get(j);
+            } else {
+                return _TABLES.utf16_closers.get(j);
+            }
+        }
+
+        template <typename InputT> static constexpr size_t _openerSize(size_t j) {
+            if constexpr (std::is_same_v<InputT, wchar_t>) {
+                return _TABLES.closers.opener_sizes[j];
+            } else if constexpr (is_utf8_v<InputT>) {
+                return _TABLES.utf8_closers.opener_sizes[j];
+            } else {
+                return _TABLES.utf16_closers.opener_sizes[j];
+            }
+        }
+
+    public:
+        /**
+         * @brief Returns the id of the token text, the same as the id of the tokens.
+         *
+         * @param token - the text of the token.
+         *
+         * @return uint64_t
+         */
+        template <class CharT> static constexpr uint64_t tokenId(const CharT* token) {
+            return defineTokenId<uint64_t, CharT>(token);
+        }
+
+        /**
+         * @brief Returns the number of states of the automaton.
+         *
+         * @return size_t
+         */
+        static constexpr size_t getStatesNumber() {
+            return _SIZES.transitions / _classes_number;
+        }
+
+        /**
+         * @brief Starts lexical analysis of the string contents. The tokens have the
+         * character type of the contents: UTF-8 for char and char8_t, UTF-16 for
+         * char16_t.
+         *
+         * @param str - the string contents.
+         *
+         * @return BasicLexerContaner<CharT>
+         */
+        template <class CharT>
+        BasicLexerContaner<CharT> createTokens(std::basic_string_view<CharT> str) const {
+            // the ids are calculated by defineTextId without an indirect call
+            const BasicTokenIdentifier<CharT> tokenId;
+            if constexpr (std::is_same_v<CharT, char8_t>) {
+                return DfaScanner<StaticLexer>::template scan<CharT>(*this, asChars(str),
+                                                                     tokenId);
+            } else {
+                return DfaScanner<StaticLexer>::template scan<CharT>(*this, str, tokenId);
+            }
+        }
+
+        /**
+         * @brief Starts lexical analysis of the string contents.
+         *
+         * @param str - the string contents.
+         *
+         * @return BasicLexerContaner<CharT>
+         */
+        template <class CharT>
+        BasicLexerContaner<CharT>
+        createTokens(const std::basic_string<CharT>& str) const {
+            return createTokens(std::basic_string_view<CharT>(str));
+        }
+
+        /**
+         * @brief Starts lexical analysis of the string contents.
+         *
+         * @param str - the string contents.
+         *
+         * @return BasicLexerContaner<CharT>
+         */
+        template <class CharT>
+        BasicLexerContaner<CharT> createTokens(const CharT* str) const {
+            return createTokens(std::basic_string_view<CharT>(str));
+        }
+    };
+}  // namespace lexer
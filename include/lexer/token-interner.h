@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace lexer {
+    /**
+     * @brief Stores every distinct token text once and numbers the texts by dense ids
+     * in the order they were met.
+     * The texts are kept in blocks that are never moved, so the views returned by
+     * getText are valid while the interner is alive. Texts are found by their hashes,
+     * and the texts themselves are compared when the hashes are equal, so different
+     * texts never get the same id.
+     * The functions may be called by several threads at once. Texts that are already
+     * stored are found without a lock, only storing a new text takes one.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
+     */
+    template <class CharT> class BasicTokenInterner {
+    public:
+        using string_view_t = std::basic_string_view<CharT>;
+        using symbol_t = uint32_t;
+
+        /**
+         * @brief The id of a text that is not interned.
+         */
+        static constexpr symbol_t NO_SYMBOL = UINT32_MAX;
+
+        /**
+         * @brief The number of characters in a block of texts.
+         */
+        static constexpr size_t BLOCK_SIZE = 1 << 16;
+
+    private:
+        std::vector<std::unique_ptr<CharT[]>> _blocks;
+        size_t _block_used;  // characters used in the last block
+        std::vector<std::unique_ptr<CharT[]>> _long_texts;  // longer than BLOCK_SIZE / 4
+
+        // the texts by their ids, the k-th segment keeps FIRST_SEGMENT << k texts, so
+        // the segments are never moved
+        static constexpr size_t FIRST_SEGMENT = 64;
+        std::array<std::unique_ptr<string_view_t[]>, 32> _texts;
+        std::atomic<size_t> _size;
+
+        // a slot keeps symbol + 1 or 0 if it is empty, the hash and the text are
+        // written before the symbol is published
+        struct _Slot {
+            std::atomic<symbol_t> symbol;
+            uint64_t hash;
+            string_view_t text;
+        };
+
+        // open addressing, the size is a power of two
+        struct _Table {
+            std::unique_ptr<_Slot[]> slots;
+            size_t size;
+        };
+
+        // the replaced tables are kept, lookups without the lock may still read them
+        std::vector<std::unique_ptr<_Table>> _tables;
+        std::atomic<const _Table*> _table;
+
+        mutable std::mutex _mutex;  // guards storing texts
+
+        static size_t _homeSlot(uint64_t hash, size_t slots_number);
+        string_view_t& _textOf(symbol_t symbol) const;
+        static symbol_t _probe(const _Table& table, string_view_t text, uint64_t hash,
+                               size_t& slot);
+        string_view_t _store(string_view_t text);
+        void _grow();
+
+    public:
+        /**
+         * @brief Creates an empty interner.
+         */
+        BasicTokenInterner();
+
+        BasicTokenInterner(const BasicTokenInterner&) = delete;
+        BasicTokenInterner& operator=(const BasicTokenInterner&) = delete;
+
+        /**
+         * @brief Returns the id of the text, the text is stored if it is new.
+         *
+         * @param text - a token text.
+         * @param hash - the hash of the text, equal texts must have equal hashes.
+         *
+         * @return symbol_t
+         */
+        symbol_t intern(string_view_t text, uint64_t hash);
+
+        /**
+         * @brief Returns the id of the text, the text is stored if it is new. The text is
+         * hashed by defineTextId.
+         *
+         * @param text - a token text.
+         *
+         * @return symbol_t
+         */
+        symbol_t intern(string_view_t text);
+
+        /**
+         * @brief Returns the id of the text or NO_SYMBOL if the text is not stored.
+         *
+         * @param text - a token text.
+         * @param hash - the hash of the text.
+         *
+         * @return symbol_t
+         */
+        symbol_t find(string_view_t text, uint64_t hash) const;
+
+        /**
+         * @brief Returns the id of the text or NO_SYMBOL if the text is not stored. The
+         * text is hashed by defineTextId.
+         *
+         * @param text - a token text.
+         *
+         * @return symbol_t
+         */
+        symbol_t find(string_view_t text) const;
+
+        /**
+         * @brief Returns the stored text.
+         *
+         * @param symbol - the id of the text.
+         *
+         * @return string_view_t
+         */
+        string_view_t getText(symbol_t symbol) const;
+
+        /**
+         * @brief Returns the number of stored texts, the ids are less than it.
+         *
+         * @return size_t
+         */
+        size_t getSize() const;
+    };
+
+    extern template class BasicTokenInterner<char>;
+    extern template class BasicTokenInterner<char8_t>;
+    extern template class BasicTokenInterner<char16_t>;
+    extern template class BasicTokenInterner<wchar_t>;
+
+    using TokenInterner = BasicTokenInterner<wchar_t>;
+}  // namespace lexer
@@ -1,10 +1,55 @@
 #pragma once
 
+#include <algorithm>
 #include <string>
+#include <string_view>
 #include <functional>
+#include <type_traits>
 #include <vector>
 
 namespace lexer {
+    /**
+     * @brief The hash of an empty text, the initial state of updateTextId.
+     */
+    template <class INT = uint64_t>
+    constexpr INT TEXT_ID_BASIS = sizeof(INT) == 4 ? 0x811c9dc5 : 0xcbf29ce484222325;
+
+    /**
+     * @brief Adds a character to the hash of a text, so that the hash can be calculated
+     * while the text is read. Use FNV-1a.
+     *
+     * @param hash - the hash of the text before the character.
+     * @param c - the next character of the text.
+     *
+     * @return INT
+     */
+    template <class INT = uint64_t, class CharT = wchar_t>
+    constexpr INT updateTextId(INT hash, CharT c) {
+        hash ^= static_cast<INT>(static_cast<std::make_unsigned_t<CharT>>(c));
+        if constexpr (sizeof(INT) == 4) {
+            return hash * 0x01000193;
+        } else {
+            return hash * 0x100000001b3;
+        }
+    }
+
+    /**
+     * @brief Calculates the hash of the token text.
+     * Use FNV-1a.
+     *
+     * @param token - the text of the token.
+     *
+     * @return INT
+     */
+    template <class INT = uint64_t, class CharT = wchar_t>
+    constexpr INT defineTextId(std::basic_string_view<CharT> token) {
+        INT hash = TEXT_ID_BASIS<INT>;
+        for (CharT c : token) {
+            hash = updateTextId<INT, CharT>(hash, c);
+        }
+        return hash;
+    }
+
     /**
      * @brief Calculates the hash of the token.
      * Use FNV-1a.
@@ -13,90 +58,203 @@ namespace lexer {
      *
      * @return uint64_t
      */
-    template <class INT = uint64_t> constexpr INT defineTokenId(const wchar_t* token) {
-        INT hash = 0xcbf29ce484222325;
-        if constexpr (sizeof(INT) == 4) {
-            hash = 0x811c9dc5;
+    template <class INT = uint64_t, class CharT = wchar_t>
+    constexpr INT defineTokenId(const CharT* token) {
+        return defineTextId<INT, CharT>(std::basic_string_view<CharT>(token));
+    }
+
+    /**
+     * @brief Identifies token texts by a function of null-terminated texts.
+     * The default function defineTokenId is recognised and called directly on the text,
+     * other functions are called through std::function with a null-terminated copy of
+     * the text.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
+     */
+    template <class CharT> class BasicTokenIdentifier {
+    public:
+        using string_view_t = std::basic_string_view<CharT>;
+        using define_id_func_t = std::function<uint64_t(const CharT*)>;
+
+    private:
+        define_id_func_t _defineId;
+        bool _is_default;
+
+    public:
+        /**
+         * @brief Identifies tokens by defineTokenId.
+         */
+        BasicTokenIdentifier();
+
+        /**
+         * @brief Identifies tokens by the function.
+         *
+         * @param defineId - a function for identifying tokens.
+         */
+        BasicTokenIdentifier(define_id_func_t defineId);
+
+        /**
+         * @brief Returns the function for identifying tokens.
+         *
+         * @return define_id_func_t
+         */
+        const define_id_func_t& getFunction() const;
+
+        /**
+         * @brief Returns true if the function is defineTokenId, then the ids can be
+         * calculated by updateTextId while the texts are read.
+         *
+         * @return bool
+         */
+        bool isIncremental() const {
+            return _is_default;
         }
-        for (size_t i = 0; token[i] != L'\0'; ++i) {
-            hash ^= static_cast<INT>(token[i]);
-            if constexpr (sizeof(INT) == 4) {
-                hash *= 0x01000193;
-            } else {
-                hash *= 0x100000001b3;
+
+        /**
+         * @brief Returns the id of the token text.
+         *
+         * @param text - the text of the token.
+         *
+         * @return uint64_t
+         */
+        uint64_t operator()(string_view_t text) const {
+            if (_is_default) {
+                return defineTextId<uint64_t, CharT>(text);
             }
+            // the buffer is reused by all calls of the thread
+            thread_local std::basic_string<CharT> terminated;
+            terminated.assign(text);
+            return _defineId(terminated.c_str());
         }
-        return hash;
-    }
 
-    class Token {
+        /**
+         * @brief Returns the id of the text and adds the number of its line breaks to
+         * lines. An incremental identifier reads the text once for both.
+         *
+         * @param text - the text of the token.
+         * @param lines - the counter of line breaks.
+         *
+         * @return uint64_t
+         */
+        uint64_t identifyCountingLines(string_view_t text, size_t& lines) const {
+            if (!_is_default) {
+                lines += std::count(text.begin(), text.end(), CharT('\n'));
+                return (*this)(text);
+            }
+            uint64_t id = TEXT_ID_BASIS<uint64_t>;
+            size_t breaks = 0;
+            for (CharT c : text) {
+                id = updateTextId<uint64_t, CharT>(id, c);
+                breaks += c == CharT('\n');
+            }
+            lines += breaks;
+            return id;
+        }
+    };
+
+    /**
+     * @brief A token of text with characters of the type CharT.
+     * The token either owns its text or refers to the text owned by a container of
+     * tokens, see makeView. The id is calculated once when the text is set and is
+     * copied with the token.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
+     */
+    template <class CharT> class BasicToken {
     public:
-        using define_id_func_t = std::function<uint64_t(const wchar_t*)>;
+        using char_t = CharT;
+        using string_t = std::basic_string<CharT>;
+        using string_view_t = std::basic_string_view<CharT>;
+        using define_id_func_t = std::function<uint64_t(const CharT*)>;
 
     private:
         uint64_t _id;
 
-        std::wstring _text;
+        string_t _text;
 
-        define_id_func_t _defineId;
-
-        void _updateId();
+        // the text owned by somebody else, null if the token owns _text
+        string_view_t _view;
 
     public:
         /**
          * @brief Sets id = 0 and text = ""
          */
-        Token();
+        BasicToken();
 
         /**
          * @brief Sets id = 0 and text.
          *
          * @param text - a token text.
          */
-        Token(const std::wstring& text);
-
-        /**
-         * @brief Sets id = 0, text = "" and defineId.
-         *
-         * @param defineId - a function for identifying tokens.
-         */
-        Token(define_id_func_t defineId);
+        BasicToken(const string_t& text);
 
         /**
-         * @brief Sets id = 0, text and defineId.
+         * @brief Sets text and the id calculated by defineId.
          *
          * @param defineId - a function for identifying tokens.
          * @param text - a token text.
          */
-        Token(define_id_func_t defineId, const std::wstring& text);
+        BasicToken(const define_id_func_t& defineId, const string_t& text);
 
         /**
          * @brief Copy constructor.
          *
          * @param other - another token.
          */
-        Token(const Token& other);
+        BasicToken(const BasicToken& other);
 
         /**
          * @brief Move constructor.
          *
          * @param other - another token.
          */
-        Token(Token&& other) noexcept;
+        BasicToken(BasicToken&& other) noexcept;
 
         /**
-         * @brief Sets a token text.
+         * @brief Creates a token with the already calculated id.
+         *
+         * @param id - the id of the text.
+         * @param text - a token text.
+         *
+         * @return BasicToken
+         */
+        static BasicToken make(uint64_t id, string_t&& text) noexcept;
+
+        /**
+         * @brief Creates a token that refers to the text instead of copying it. The
+         * text must outlive the token and all its copies.
+         *
+         * @param id - the id of the text.
+         * @param text - a token text.
+         *
+         * @return BasicToken
+         */
+        static BasicToken makeView(uint64_t id, string_view_t text) noexcept;
+
+        /**
+         * @brief Sets a token text and its id calculated by defineTokenId. The token
+         * owns the text after that.
+         *
+         * @param new_text - a new token text.
+         */
+        void setText(const string_t& new_text);
+
+        /**
+         * @brief Sets a token text and its id calculated by defineTokenId. The token
+         * owns the text after that.
          *
          * @param new_text - a new token text.
          */
-        void setText(const std::wstring& new_text);
+        void setText(string_t&& new_text) noexcept;
 
         /**
-         * @brief Sets a token text.
+         * @brief Sets a token text and its id calculated by defineId. The token owns
+         * the text after that.
          *
          * @param new_text - a new token text.
+         * @param defineId - a function for identifying tokens.
          */
-        void setText(std::wstring&& new_text) noexcept;
+        void setText(const string_t& new_text, const define_id_func_t& defineId);
 
         /**
          * @brief Return token id.
@@ -106,35 +264,52 @@ namespace lexer {
         uint64_t getId() const;
 
         /**
-         * @brief Return token text.
+         * @brief Return token text. The view is valid while the token and the text it
+         * refers to are alive.
          *
-         * @return std::wstring
+         * @return string_view_t
          */
-        std::wstring getText() const;
+        string_view_t getText() const;
+
+        /**
+         * @brief Returns "true" if the token refers to the text owned by somebody else.
+         *
+         * @return bool
+         */
+        bool isView() const;
 
         /**
          * @brief Copy constructor.
          *
          * @param right - another token.
          */
-        Token& operator=(const Token& right);
+        BasicToken& operator=(const BasicToken& right);
 
         /**
          * @brief Move constructor.
          *
          * @param right - another token.
          */
-        Token& operator=(Token&& right) noexcept;
+        BasicToken& operator=(BasicToken&& right) noexcept;
 
         /**
-         * @brief Compares the text of the tokens.
+         * @brief Compares the text of the tokens. The texts are compared only if the ids
+         * are equal and the tokens do not refer to the same text, such as the tokens
+         * of a container with a token interner.
          *
          * @param left - left token.
          * @param right - right token.
          *
          * @return bool
          */
-        friend bool operator==(const Token& left, const Token& right);
+        friend bool operator==(const BasicToken& left, const BasicToken& right) {
+            if (left._id != right._id) {
+                return false;
+            }
+            string_view_t left_text = left.getText(), right_text = right.getText();
+            return left_text.size() == right_text.size() &&
+                   (left_text.data() == right_text.data() || left_text == right_text);
+        }
 
         /**
          * @brief Compares the text of the tokens.
@@ -144,16 +319,21 @@ namespace lexer {
          *
          * @return bool
          */
-        friend bool operator!=(const Token& left, const Token& right);
+        friend bool operator!=(const BasicToken& left, const BasicToken& right) {
+            return !(left == right);
+        }
     };
 
     /**
      * @brief Defines a string of tokens.
      * In addition to the tokens themselves, the row number and the original row are
      * stored.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
      */
-    struct TokenLine {
-        using token_contaner_t = std::vector<Token>;
+    template <class CharT> struct BasicTokenLine {
+        using string_t = std::basic_string<CharT>;
+        using token_contaner_t = std::vector<BasicToken<CharT>>;
 
         /**
          * @brief The row number.
@@ -163,7 +343,7 @@ namespace lexer {
         /**
          * @brief The original row.
          */
-        std::wstring original;
+        string_t original;
 
         /**
          * @brief List of tokens.
@@ -173,7 +353,7 @@ namespace lexer {
         /**
          * @brief Sets line_number = 0.
          */
-        TokenLine();
+        BasicTokenLine();
 
         /**
          * @brief Sets line_number, original and tokens.
@@ -182,36 +362,36 @@ namespace lexer {
          * @param original - a original row.
          * @param tokens - a list of tokens.
          */
-        TokenLine(size_t line_number, const std::wstring& original,
-                  const token_contaner_t& tokens);
+        BasicTokenLine(size_t line_number, const string_t& original,
+                       const token_contaner_t& tokens);
 
         /**
          * @brief Copy constructor.
          *
          * @param other - another TokenLine.
          */
-        TokenLine(const TokenLine& other);
+        BasicTokenLine(const BasicTokenLine& other);
 
         /**
          * @brief Move constructor.
          *
          * @param other - another TokenLine.
          */
-        TokenLine(TokenLine&& other) noexcept;
+        BasicTokenLine(BasicTokenLine&& other) noexcept;
 
         /**
          * @brief Copy operator.
          *
          * @param right - another TokenLine.
          */
-        TokenLine& operator=(const TokenLine& right);
+        BasicTokenLine& operator=(const BasicTokenLine& right);
 
         /**
          * @brief Move operator.
          *
          * @param right - another TokenLine.
          */
-        TokenLine& operator=(TokenLine&& right) noexcept;
+        BasicTokenLine& operator=(BasicTokenLine&& right) noexcept;
 
         /**
          * @brief Compares the TokenLines.
@@ -221,7 +401,9 @@ namespace lexer {
          *
          * @return bool
          */
-        friend bool operator==(const TokenLine& left, const TokenLine& right);
+        friend bool operator==(const BasicTokenLine& left, const BasicTokenLine& right) {
+            return left.line_number == right.line_number && left.tokens == right.tokens;
+        }
 
         /**
          * @brief Compares the TokenLines.
@@ -231,22 +413,26 @@ namespace lexer {
          *
          * @return bool
          */
-        friend bool operator!=(const TokenLine& left, const TokenLine& right);
+        friend bool operator!=(const BasicTokenLine& left, const BasicTokenLine& right) {
+            return !(left == right);
+        }
     };
 
     /**
      * @brief Defines the combining tokens.
+     *
+     * @tparam CharT - char, char8_t, char16_t or wchar_t.
      */
-    struct CombiningTokens {
+    template <class CharT> struct BasicCombiningTokens {
         /**
          * @brief The initial token.
          */
-        Token start;
+        BasicToken<CharT> start;
 
         /**
          * @brief The final token.
          */
-        Token end;
+        BasicToken<CharT> end;
 
         /**
          * Init start and end tokens.
@@ -254,35 +440,36 @@ namespace lexer {
          * @param start - the initial token.
          * @param end - the final token.
          */
-        CombiningTokens(const Token& start, const Token& end);
+        BasicCombiningTokens(const BasicToken<CharT>& start,
+                             const BasicToken<CharT>& end);
 
         /**
          * @brief Copy constructor.
          *
          * @param other - another CombiningTokens.
          */
-        CombiningTokens(const CombiningTokens& other);
+        BasicCombiningTokens(const BasicCombiningTokens& other);
 
         /**
          * @brief Move constructor.
          *
          * @param other - another CombiningTokens.
          */
-        CombiningTokens(CombiningTokens&& other) noexcept;
+        BasicCombiningTokens(BasicCombiningTokens&& other) noexcept;
 
         /**
          * @brief Copy operator.
          *
          * @param right - another CombiningTokens.
          */
-        CombiningTokens& operator=(const CombiningTokens& right);
+        BasicCombiningTokens& operator=(const BasicCombiningTokens& right);
 
         /**
          * @brief Move operator.
          *
          * @param right - another CombiningTokens.
          */
-        CombiningTokens& operator=(CombiningTokens&& right) noexcept;
+        BasicCombiningTokens& operator=(BasicCombiningTokens&& right) noexcept;
 
         /**
          * @brief Compares the CombiningTokens.
@@ -292,7 +479,10 @@ namespace lexer {
          *
          * @return bool
          */
-        friend bool operator==(const CombiningTokens& left, const CombiningTokens& right);
+        friend bool operator==(const BasicCombiningTokens& left,
+                               const BasicCombiningTokens& right) {
+            return left.start == right.start && left.end == right.end;
+        }
 
         /**
          * @brief Compares the CombiningTokens.
@@ -302,6 +492,34 @@ namespace lexer {
          *
          * @return bool
          */
-        friend bool operator!=(const CombiningTokens& left, const CombiningTokens& right);
+        friend bool operator!=(const BasicCombiningTokens& left,
+                               const BasicCombiningTokens& right) {
+            return !(left == right);
+        }
     };
+
+    extern template class BasicTokenIdentifier<char>;
+    extern template class BasicTokenIdentifier<char8_t>;
+    extern template class BasicTokenIdentifier<char16_t>;
+    extern template class BasicTokenIdentifier<wchar_t>;
+
+    extern template class BasicToken<char>;
+    extern template class BasicToken<char8_t>;
+    extern template class BasicToken<char16_t>;
+    extern template class BasicToken<wchar_t>;
+
+    extern template struct BasicTokenLine<char>;
+    extern template struct BasicTokenLine<char8_t>;
+    extern template struct BasicTokenLine<char16_t>;
+    extern template struct BasicTokenLine<wchar_t>;
+
+    extern template struct BasicCombiningTokens<char>;
+    extern template struct BasicCombiningTokens<char8_t>;
+    extern template struct BasicCombiningTokens<char16_t>;
+    extern template struct BasicCombiningTokens<wchar_t>;
+
+    using TokenIdentifier = BasicTokenIdentifier<wchar_t>;
+    using Token = BasicToken<wchar_t>;
+    using TokenLine = BasicTokenLine<wchar_t>;
+    using CombiningTokens = BasicCombiningTokens<wchar_t>;
 }  // namespace lexer
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <cstddef>
+#include <locale>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace lexer {
+    /**
+     * @brief Decodes the code point at the beginning of UTF-8 text. An invalid sequence
+     * is decoded as U+FFFD and takes one byte.
+     *
+     * @param text - non-empty UTF-8 text.
+     * @param size - receives the number of bytes of the code point.
+     *
+     * @return char32_t
+     */
+    char32_t decodeUtf8(std::string_view text, size_t& size);
+
+    /**
+     * @brief Returns the number of bytes of the UTF-8 sequence declared by its first
+     * byte, 1 for an ASCII or invalid first byte.
+     *
+     * @param first - the first byte of the sequence.
+     *
+     * @return size_t
+     */
+    template <class UnitT> constexpr size_t utf8CharSize(UnitT first) {
+        const unsigned char byte = static_cast<unsigned char>(first);
+        if ((byte & 0xE0) == 0xC0) {
+            return 2;
+        } else if ((byte & 0xF0) == 0xE0) {
+            return 3;
+        } else if ((byte & 0xF8) == 0xF0) {
+            return 4;
+        }
+        return 1;
+    }
+
+    /**
+     * @brief Decodes the code point at the beginning of UTF-16 text. A lone surrogate
+     * takes one unit and is returned as is.
+     *
+     * @param text - non-empty UTF-16 text.
+     * @param size - receives the number of units of the code point.
+     *
+     * @return char32_t
+     */
+    char32_t decodeUtf16(std::u16string_view text, size_t& size);
+
+    /**
+     * @brief Thrown when UTF-8 text that has to be valid has an invalid sequence.
+     */
+    class Utf8Error : public std::runtime_error {
+    private:
+        size_t _offset;
+
+    public:
+        /**
+         * @brief Reports the invalid sequence.
+         *
+         * @param offset - the offset of the sequence in bytes.
+         */
+        Utf8Error(size_t offset);
+
+        /**
+         * @brief Returns the offset of the invalid sequence in bytes.
+         *
+         * @return size_t
+         */
+        size_t getOffset() const;
+    };
+
+    /**
+     * @brief Converts UTF-8 text to wide characters. Runs of ASCII are converted 32
+     * bytes at a time with vector operations if the processor supports them. An invalid
+     * sequence is converted to U+FFFD and takes one byte.
+     *
+     * @param text - UTF-8 text.
+     *
+     * @return std::wstring
+     */
+    std::wstring utf8ToWide(std::string_view text);
+
+    /**
+     * @brief Converts valid UTF-8 text to wide characters, throws Utf8Error at the first
+     * invalid sequence.
+     *
+     * @param text - UTF-8 text.
+     *
+     * @return std::wstring
+     */
+    std::wstring utf8ToWideStrict(std::string_view text);
+
+    /**
+     * @brief Converts UTF-8 text to UTF-16 the same way as utf8ToWide.
+     *
+     * @param text - UTF-8 text.
+     *
+     * @return std::u16string
+     */
+    std::u16string utf8ToUtf16(std::string_view text);
+
+    /**
+     * @brief Returns the offset of the first invalid sequence of UTF-8 text in bytes or
+     * std::string_view::npos if the text is valid.
+     *
+     * @param text - UTF-8 text.
+     *
+     * @return size_t
+     */
+    size_t findInvalidUtf8(std::string_view text);
+
+    /**
+     * @brief Converts UTF-8 files of wide streams, for example std::wifstream, to wide
+     * characters by the same decoder as utf8ToWide. An invalid sequence is read as
+     * U+FFFD.
+     */
+    class Utf8Codecvt : public std::codecvt<wchar_t, char, std::mbstate_t> {
+    protected:
+        result do_in(state_type& state, const char* from, const char* from_end,
+                     const char*& from_next, wchar_t* to, wchar_t* to_end,
+                     wchar_t*& to_next) const override;
+        result do_out(state_type& state, const wchar_t* from, const wchar_t* from_end,
+                      const wchar_t*& from_next, char* to, char* to_end,
+                      char*& to_next) const override;
+        result do_unshift(state_type& state, char* to, char* to_end,
+                          char*& to_next) const override;
+        int do_encoding() const noexcept override;
+        bool do_always_noconv() const noexcept override;
+        int do_length(state_type& state, const char* from, const char* from_end,
+                      size_t max) const override;
+        int do_max_length() const noexcept override;
+
+    public:
+        /**
+         * @brief Creates the facet.
+         *
+         * @param refs - 0 if the locale deletes the facet.
+         */
+        explicit Utf8Codecvt(size_t refs = 0);
+    };
+
+    /**
+     * @brief Converts wide characters to UTF-8 text. It is a constant expression, so
+     * that the tables of the automaton may be built at compile time.
+     *
+     * @param text - wide characters.
+     *
+     * @return std::string
+     */
+    constexpr std::string wideToUtf8(std::wstring_view text) {
+        std::string utf8;
+        utf8.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i) {
+            char32_t c = static_cast<std::make_unsigned_t<wchar_t>>(text[i]);
+            if constexpr (sizeof(wchar_t) == 2) {
+                if (c >= 0xD800 && c < 0xDC00 && i + 1 < text.size()) {
+                    char32_t low =
+                        static_cast<std::make_unsigned_t<wchar_t>>(text[i + 1]);
+                    if (low >= 0xDC00 && low < 0xE000) {
+                        c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                        ++i;
+                    }
+                }
+            }
+            if (c < 0x80) {
+                utf8.push_back(static_cast<char>(c));
+            } else if (c < 0x800) {
+                utf8.push_back(static_cast<char>(0xC0 | c >> 6));
+                utf8.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            } else if (c < 0x10000) {
+                utf8.push_back(static_cast<char>(0xE0 | c >> 12));
+                utf8.push_back(static_cast<char>(0x80 | (c >> 6 & 0x3F)));
+                utf8.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            } else {
+                utf8.push_back(static_cast<char>(0xF0 | c >> 18));
+                utf8.push_back(static_cast<char>(0x80 | (c >> 12 & 0x3F)));
+                utf8.push_back(static_cast<char>(0x80 | (c >> 6 & 0x3F)));
+                utf8.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            }
+        }
+        return utf8;
+    }
+
+    /**
+     * @brief Converts UTF-16 text to wide characters.
+     *
+     * @param text - UTF-16 text.
+     *
+     * @return std::wstring
+     */
+    std::wstring utf16ToWide(std::u16string_view text);
+
+    /**
+     * @brief Converts wide characters to UTF-16 text. It is a constant expression.
+     *
+     * @param text - wide characters.
+     *
+     * @return std::u16string
+     */
+    constexpr std::u16string wideToUtf16(std::wstring_view text) {
+        if constexpr (sizeof(wchar_t) == 2) {
+            return std::u16string(text.begin(), text.end());
+        }
+        std::u16string utf16;
+        utf16.reserve(text.size());
+        for (wchar_t wide_c : text) {
+            char32_t c = static_cast<std::make_unsigned_t<wchar_t>>(wide_c);
+            if (c >= 0x10000) {
+                c -= 0x10000;
+                utf16.push_back(static_cast<char16_t>(0xD800 + (c >> 10)));
+                utf16.push_back(static_cast<char16_t>(0xDC00 + (c & 0x3FF)));
+            } else {
+                utf16.push_back(static_cast<char16_t>(c));
+            }
+        }
+        return utf16;
+    }
+
+    /**
+     * @brief "true" if the text of the character type is UTF-8.
+     */
+    template <class CharT>
+    constexpr bool is_utf8_v =
+        std::is_same_v<CharT, char> || std::is_same_v<CharT, char8_t>;
+
+    /**
+     * @brief "true" if the text of the character type is UTF-16.
+     */
+    template <class CharT>
+    constexpr bool is_utf16_v = std::is_same_v<CharT, char16_t> ||
+                                (std::is_same_v<CharT, wchar_t> && sizeof(wchar_t) == 2);
+
+    /**
+     * @brief Views UTF-8 text of any byte type as chars.
+     *
+     * @param text - UTF-8 text.
+     *
+     * @return std::string_view
+     */
+    template <class CharT> std::string_view asChars(std::basic_string_view<CharT> text) {
+        static_assert(is_utf8_v<CharT>);
+        return std::string_view(reinterpret_cast<const char*>(text.data()), text.size());
+    }
+
+    /**
+     * @brief Decodes the code point at the beginning of the text.
+     *
+     * @param text - non-empty text.
+     * @param size - receives the number of units of the code point.
+     *
+     * @return char32_t
+     */
+    template <class CharT>
+    char32_t decodeChar(std::basic_string_view<CharT> text, size_t& size) {
+        if constexpr (is_utf8_v<CharT>) {
+            return decodeUtf8(asChars(text), size);
+        } else if constexpr (is_utf16_v<CharT>) {
+            return decodeUtf16(
+                std::u16string_view(reinterpret_cast<const char16_t*>(text.data()),
+                                    text.size()),
+                size);
+        } else {
+            size = 1;
+            return static_cast<char32_t>(text[0]);
+        }
+    }
+
+    /**
+     * @brief Appends the code point to the text of the character type: as UTF-8, as
+     * UTF-16 or as one wide character.
+     *
+     * @param text - the text of any character type.
+     * @param c - the code point.
+     */
+    template <class CharT, class Traits, class Allocator>
+    constexpr void appendChar(std::basic_string<CharT, Traits, Allocator>& text,
+                              char32_t c) {
+        if constexpr (is_utf8_v<CharT>) {
+            if (c < 0x80) {
+                text.push_back(static_cast<CharT>(c));
+            } else if (c < 0x800) {
+                text.push_back(static_cast<CharT>(0xC0 | c >> 6));
+                text.push_back(static_cast<CharT>(0x80 | (c & 0x3F)));
+            } else if (c < 0x10000) {
+                text.push_back(static_cast<CharT>(0xE0 | c >> 12));
+                text.push_back(static_cast<CharT>(0x80 | (c >> 6 & 0x3F)));
+                text.push_back(static_cast<CharT>(0x80 | (c & 0x3F)));
+            } else {
+                text.push_back(static_cast<CharT>(0xF0 | c >> 18));
+                text.push_back(static_cast<CharT>(0x80 | (c >> 12 & 0x3F)));
+                text.push_back(static_cast<CharT>(0x80 | (c >> 6 & 0x3F)));
+                text.push_back(static_cast<CharT>(0x80 | (c & 0x3F)));
+            }
+        } else if constexpr (is_utf16_v<CharT>) {
+            if (c >= 0x10000) {
+                c -= 0x10000;
+                text.push_back(static_cast<CharT>(0xD800 + (c >> 10)));
+                text.push_back(static_cast<CharT>(0xDC00 + (c & 0x3FF)));
+            } else {
+                text.push_back(static_cast<CharT>(c));
+            }
+        } else {
+            text.push_back(static_cast<CharT>(c));
+        }
+    }
+
+    /**
+     * @brief Converts the text of any character type to wide characters.
+     *
+     * @param text - the text.
+     *
+     * @return std::wstring
+     */
+    template <class CharT> std::wstring toWide(std::basic_string_view<CharT> text) {
+        if constexpr (std::is_same_v<CharT, wchar_t>) {
+            return std::wstring(text);
+        } else if constexpr (is_utf8_v<CharT>) {
+            return utf8ToWide(asChars(text));
+        } else {
+            return utf16ToWide(text);
+        }
+    }
+
+    /**
+     * @brief Converts UTF-8 text to the text of the character type.
+     *
+     * @param text - UTF-8 text.
+     *
+     * @return std::basic_string<CharT>
+     */
+    template <class CharT> std::basic_string<CharT> fromUtf8(std::string_view text) {
+        if constexpr (std::is_same_v<CharT, wchar_t>) {
+            return utf8ToWide(text);
+        } else if constexpr (is_utf8_v<CharT>) {
+            return std::basic_string<CharT>(text.begin(), text.end());
+        } else {
+            return utf8ToUtf16(text);
+        }
+    }
+
+    /**
+     * @brief Converts wide characters to the text of the character type.
+     *
+     * @param text - wide characters.
+     *
+     * @return std::basic_string<CharT>
+     */
+    template <class CharT> std::basic_string<CharT> fromWide(std::wstring_view text) {
+        if constexpr (std::is_same_v<CharT, wchar_t>) {
+            return std::wstring(text);
+        } else if constexpr (is_utf8_v<CharT>) {
+            std::string utf8 = wideToUtf8(text);
+            return std::basic_string<CharT>(utf8.begin(), utf8.end());
+        } else {
+            return wideToUtf16(text);
+        }
+    }
+}  // namespace lexer
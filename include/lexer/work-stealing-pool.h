@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <span>
+
+namespace lexer {
+    /**
+     * @brief Runs many tasks of very different sizes on several threads.
+     * Every thread has its own queue of tasks. The tasks are dealt to the queues in
+     * the given order, a thread takes the tasks of its queue from the front and, when
+     * its queue is empty, steals the front task of another queue. If the tasks are
+     * given from the largest to the smallest, the large ones are started first and
+     * the small ones fill the threads that would stay idle at the end.
+     */
+    class WorkStealingPool {
+    private:
+        struct _Queue {
+            std::mutex mutex;
+            std::deque<size_t> tasks;
+        };
+
+        size_t _threads_number;
+
+        static bool _take(_Queue& queue, size_t& task);
+
+    public:
+        /**
+         * @brief Prepares the pool.
+         *
+         * @param threads - the number of threads, 0 means one thread per core.
+         */
+        explicit WorkStealingPool(size_t threads = 0);
+
+        /**
+         * @brief Runs the tasks and waits for all of them, the calling thread is one of
+         * the threads of the pool. If a task throws, the other tasks are still run and
+         * then the first error is thrown.
+         *
+         * @param tasks - the numbers of the tasks in the order they should be started.
+         * @param task - runs the task with the given number.
+         */
+        void run(std::span<const size_t> tasks,
+                 const std::function<void(size_t)>& task) const;
+
+        /**
+         * @brief Returns the number of threads.
+         *
+         * @return size_t
+         */
+        size_t getThreadsNumber() const;
+    };
+}  // namespace lexer
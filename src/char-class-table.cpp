@@ -0,0 +1,23 @@
+#include "../include/lexer/char-class-table.h"
+
+using namespace lexer;
+
+CharClassTable::CharClassTable(class_t default_class) {
+    clear(default_class);
+}
+
+void CharClassTable::clear(class_t default_class) {
+    _default_class = default_class;
+    _flat.fill(default_class);
+    _other.clear();
+}
+
+void CharClassTable::set(wchar_t c, class_t char_class) {
+    if (static_cast<std::make_unsigned_t<wchar_t>>(c) < FLAT_SIZE) {
+        _flat[static_cast<std::make_unsigned_t<wchar_t>>(c)] = char_class;
+    } else if (char_class == _default_class) {
+        _other.erase(c);
+    } else {
+        _other[c] = char_class;
+    }
+}
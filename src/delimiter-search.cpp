@@ -0,0 +1,51 @@
+#include "../include/lexer/delimiter-search.h"
+
+namespace {
+    // char_traits find and compare are memchr and memcmp or their wide versions
+    template <typename CharT>
+    size_t find(std::basic_string_view<CharT> text,
+                std::basic_string_view<CharT> delimiter) {
+        using traits = std::char_traits<CharT>;
+        const size_t n = delimiter.size();
+        if (n == 0 || text.size() < n) {
+            return std::basic_string_view<CharT>::npos;
+        }
+        if (n == 1) {
+            const CharT* found = traits::find(text.data(), text.size(), delimiter[0]);
+            return found != nullptr ? static_cast<size_t>(found - text.data())
+                                    : std::basic_string_view<CharT>::npos;
+        }
+
+        const size_t last_start = text.size() - n;
+        for (size_t i = 0; i <= last_start;) {
+            const CharT* found =
+                traits::find(text.data() + i, last_start - i + 1, delimiter[0]);
+            if (found == nullptr) {
+                break;
+            }
+            i = static_cast<size_t>(found - text.data());
+            if (text[i + n - 1] == delimiter[n - 1] &&
+                traits::compare(text.data() + i + 1, delimiter.data() + 1, n - 2) == 0) {
+                return i;
+            }
+            ++i;
+        }
+        return std::basic_string_view<CharT>::npos;
+    }
+}  // namespace
+
+size_t lexer::findDelimiter(std::wstring_view text, std::wstring_view delimiter) {
+    return find(text, delimiter);
+}
+
+size_t lexer::findDelimiter(std::string_view text, std::string_view delimiter) {
+    return find(text, delimiter);
+}
+
+size_t lexer::findDelimiter(std::u8string_view text, std::u8string_view delimiter) {
+    return find(text, delimiter);
+}
+
+size_t lexer::findDelimiter(std::u16string_view text, std::u16string_view delimiter) {
+    return find(text, delimiter);
+}
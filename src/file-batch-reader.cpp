@@ -0,0 +1,477 @@
+#include "../include/lexer/file-batch-reader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LEXER_HAS_PREAD 1
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define LEXER_HAS_IO_URING 1
+#endif
+
+using namespace lexer;
+
+namespace {
+#ifdef LEXER_HAS_PREAD
+    // closes the file when reading fails
+    struct FileDescriptor {
+        int fd;
+
+        ~FileDescriptor() {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    };
+
+    std::string readWhole(const std::string& file_name) {
+        FileDescriptor file { open(file_name.c_str(), O_RDONLY) };
+        if (file.fd < 0) {
+            throw std::runtime_error("file is not exist");
+        }
+
+        std::string contents;
+        struct stat file_stat;
+        if (fstat(file.fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) &&
+            file_stat.st_size > 0) {
+            size_t size = static_cast<size_t>(file_stat.st_size);
+            bool failed = false;
+            contents.resize_and_overwrite(size, [&](char* data, size_t) {
+                size_t done = 0;
+                while (done < size) {
+                    ssize_t n = pread(file.fd, data + done, size - done,
+                                      static_cast<off_t>(done));
+                    if (n < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    failed = n < 0;
+                    if (n <= 0) {
+                        break;
+                    }
+                    done += static_cast<size_t>(n);
+                }
+                return done;
+            });
+            if (failed) {
+                throw std::runtime_error("file is not readable");
+            }
+            return contents;
+        }
+
+        // the size of a pipe or a device is not known, it is read until the end
+        char block[1 << 16];
+        for (;;) {
+            ssize_t n = read(file.fd, block, sizeof(block));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                throw std::runtime_error("file is not readable");
+            }
+            if (n == 0) {
+                break;
+            }
+            contents.append(block, static_cast<size_t>(n));
+        }
+        return contents;
+    }
+#else
+    std::string readWhole(const std::string& file_name) {
+        std::ifstream file(file_name, std::ios_base::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("file is not exist");
+        }
+        return std::string(std::istreambuf_iterator<char>(file),
+                           std::istreambuf_iterator<char>());
+    }
+#endif
+}  // namespace
+
+#ifdef LEXER_HAS_IO_URING
+// the submission and completion queues shared with the kernel
+struct FileBatchReader::_Ring {
+    // a read is limited by the 32-bit length of a request
+    static constexpr size_t MAX_READ = size_t(1) << 30;
+
+    int fd = -1;
+    void* sq_ring = MAP_FAILED;
+    size_t sq_ring_size = 0;
+    void* cq_ring = MAP_FAILED;
+    size_t cq_ring_size = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqes_size = 0;
+
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    io_uring_cqe* cqes;
+    unsigned to_submit = 0;
+
+    static std::unique_ptr<_Ring> create(unsigned entries) {
+        auto ring = std::make_unique<_Ring>();
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring->fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring->fd < 0) {
+            return nullptr;
+        }
+
+        ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring->cq_ring_size =
+            params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            ring->sq_ring_size = ring->cq_ring_size =
+                std::max(ring->sq_ring_size, ring->cq_ring_size);
+        }
+        ring->sq_ring = mmap(nullptr, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+        if (ring->sq_ring == MAP_FAILED) {
+            return nullptr;
+        }
+        if (single_mmap) {
+            ring->cq_ring = ring->sq_ring;
+        } else {
+            ring->cq_ring = mmap(nullptr, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+            if (ring->cq_ring == MAP_FAILED) {
+                return nullptr;
+            }
+        }
+        ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        ring->sqes = static_cast<io_uring_sqe*>(
+            mmap(nullptr, ring->sqes_size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES));
+        if (ring->sqes == MAP_FAILED) {
+            return nullptr;
+        }
+
+        char* sq = static_cast<char*>(ring->sq_ring);
+        char* cq = static_cast<char*>(ring->cq_ring);
+        ring->sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        ring->sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        ring->sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        ring->cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        ring->cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        ring->cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return ring;
+    }
+
+    ~_Ring() {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqes_size);
+        }
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+            munmap(cq_ring, cq_ring_size);
+        }
+        if (sq_ring != MAP_FAILED) {
+            munmap(sq_ring, sq_ring_size);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    void queueRead(int file, char* data, size_t size, size_t offset, uint64_t user_data) {
+        // only this thread writes the tail, the kernel reads it after the release
+        unsigned tail = *sq_tail;
+        unsigned index = tail & *sq_mask;
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = file;
+        sqe.addr = reinterpret_cast<uint64_t>(data);
+        sqe.len = static_cast<uint32_t>(std::min(size, MAX_READ));
+        sqe.off = offset;
+        sqe.user_data = user_data;
+        sq_array[index] = index;
+        std::atomic_ref<unsigned>(*sq_tail).store(tail + 1, std::memory_order_release);
+        ++to_submit;
+    }
+
+    void submitAndWait() {
+        for (;;) {
+            long submitted = syscall(__NR_io_uring_enter, fd, to_submit, 1,
+                                     IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (submitted >= 0) {
+                to_submit -= static_cast<unsigned>(submitted);
+                return;
+            }
+            // other errors mean the ring itself is broken
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                throw std::runtime_error("io_uring is not usable");
+            }
+        }
+    }
+
+    bool pop(io_uring_cqe& cqe) {
+        unsigned head = *cq_head;
+        if (head == std::atomic_ref<unsigned>(*cq_tail).load(std::memory_order_acquire)) {
+            return false;
+        }
+        cqe = cqes[head & *cq_mask];
+        std::atomic_ref<unsigned>(*cq_head).store(head + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+void FileBatchReader::_readWithRing() {
+    struct Slot {
+        size_t index;
+        int fd;
+        std::string contents;
+        size_t done;
+    };
+
+    // the fd of a free slot is -1
+    std::vector<Slot> slots(_queue_depth, Slot { 0, -1, std::string(), 0 });
+    std::vector<size_t> free_slots;
+    for (size_t slot = _queue_depth; slot > 0; --slot) {
+        free_slots.push_back(slot - 1);
+    }
+
+    size_t next_file = 0;
+    size_t in_flight = 0;
+    for (;;) {
+        // the ring thread waits for the consumers only when it has nothing to reap
+        while (!free_slots.empty() && next_file < _file_names.size() &&
+               _reserve(in_flight == 0)) {
+            size_t index = next_file++;
+            int fd = open(_file_names[index].c_str(), O_RDONLY);
+            if (fd < 0) {
+                _deliver(index, std::string(),
+                         std::make_exception_ptr(
+                             std::runtime_error("file is not exist")));
+                continue;
+            }
+            struct stat file_stat;
+            if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) ||
+                file_stat.st_size == 0) {
+                // pipes and devices are read until their end without the ring
+                close(fd);
+                _readAndDeliver(index);
+                continue;
+            }
+
+            size_t slot = free_slots.back();
+            free_slots.pop_back();
+            size_t size = static_cast<size_t>(file_stat.st_size);
+            slots[slot].index = index;
+            slots[slot].fd = fd;
+            slots[slot].done = 0;
+            // the kernel fills the buffer, it is not cleared first
+            slots[slot].contents.resize_and_overwrite(size, [](char*, size_t n) {
+                return n;
+            });
+            _ring->queueRead(fd, slots[slot].contents.data(), size, 0, slot);
+            ++in_flight;
+        }
+        if (in_flight == 0) {
+            break;
+        }
+
+        try {
+            _ring->submitAndWait();
+        } catch (...) {
+            // the ring is broken, but the reads the kernel has taken still write into
+            // their buffers, so they are waited for before the buffers are released;
+            // the reads left in the submission queue are never started
+            size_t started = in_flight - _ring->to_submit;
+            io_uring_cqe cqe;
+            while (started > 0) {
+                if (_ring->pop(cqe)) {
+                    --started;
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+            // the files in flight and the rest are read with pread
+            for (Slot& read : slots) {
+                if (read.fd >= 0) {
+                    close(read.fd);
+                    read.fd = -1;
+                    _readAndDeliver(read.index);
+                }
+            }
+            while (next_file < _file_names.size() && _reserve(true)) {
+                _readAndDeliver(next_file++);
+            }
+            return;
+        }
+        io_uring_cqe cqe;
+        while (_ring->pop(cqe)) {
+            size_t slot = static_cast<size_t>(cqe.user_data);
+            Slot& read = slots[slot];
+            size_t size = read.contents.size();
+            if (cqe.res > 0) {
+                read.done += static_cast<size_t>(cqe.res);
+            }
+            if ((cqe.res > 0 && read.done < size) || cqe.res == -EINTR ||
+                cqe.res == -EAGAIN) {
+                _ring->queueRead(read.fd, read.contents.data() + read.done,
+                                 size - read.done, read.done, slot);
+                continue;
+            }
+
+            close(read.fd);
+            read.fd = -1;
+            --in_flight;
+            free_slots.push_back(slot);
+            if (cqe.res < 0) {
+                // a kernel without reads in the ring, the file is read with pread
+                _readAndDeliver(read.index);
+                continue;
+            }
+            // the file has been truncated while it was read
+            read.contents.resize(read.done);
+            _deliver(read.index, std::move(read.contents), nullptr);
+        }
+    }
+}
+#else
+struct FileBatchReader::_Ring {};
+
+void FileBatchReader::_readWithRing() {}
+#endif
+
+bool FileBatchReader::_reserve(bool wait) {
+    // the files being read count against the depth as well as the read ones
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (wait) {
+        _taken_cv.wait(lock, [this]() {
+            return _stopped || _reading + _read_files.size() < _queue_depth;
+        });
+    }
+    if (_stopped || _reading + _read_files.size() >= _queue_depth) {
+        return false;
+    }
+    ++_reading;
+    return true;
+}
+
+void FileBatchReader::_release() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_reading;
+    }
+    _taken_cv.notify_one();
+}
+
+void FileBatchReader::_deliver(size_t index, std::string&& contents,
+                               std::exception_ptr error) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_reading;
+        _read_files.push_back(_ReadFile { index, std::move(contents), std::move(error) });
+    }
+    _read_cv.notify_one();
+}
+
+void FileBatchReader::_readAndDeliver(size_t index) {
+    try {
+        _deliver(index, readWhole(_file_names[index]), nullptr);
+    } catch (...) {
+        _deliver(index, std::string(), std::current_exception());
+    }
+}
+
+void FileBatchReader::_readWithPool() {
+    while (_reserve(true)) {
+        size_t index = _next_file.fetch_add(1);
+        if (index >= _file_names.size()) {
+            _release();
+            return;
+        }
+        _readAndDeliver(index);
+    }
+}
+
+FileBatchReader::FileBatchReader(std::vector<std::string> file_names,
+                                 size_t queue_depth) :
+    _file_names(std::move(file_names)),
+    _queue_depth(std::clamp<size_t>(queue_depth, 1, 4096)),
+    _reading(0),
+    _taken(0),
+    _stopped(false),
+    _next_file(0) {
+    if (_file_names.empty()) {
+        return;
+    }
+#ifdef LEXER_HAS_IO_URING
+    _ring = _Ring::create(static_cast<unsigned>(_queue_depth));
+    if (_ring != nullptr) {
+        _threads.emplace_back(&FileBatchReader::_readWithRing, this);
+        return;
+    }
+#endif
+    size_t threads = std::min({ _queue_depth, MAX_POOL_THREADS, _file_names.size() });
+    for (size_t i = 0; i < threads; ++i) {
+        _threads.emplace_back(&FileBatchReader::_readWithPool, this);
+    }
+}
+
+FileBatchReader::~FileBatchReader() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopped = true;
+    }
+    _taken_cv.notify_all();
+    for (std::thread& thread : _threads) {
+        thread.join();
+    }
+}
+
+bool FileBatchReader::next(size_t& index, std::string& contents) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _read_cv.wait(lock, [this]() {
+        return !_read_files.empty() || _taken == _file_names.size();
+    });
+    if (_read_files.empty()) {
+        return false;
+    }
+
+    _ReadFile file = std::move(_read_files.front());
+    _read_files.pop_front();
+    bool last = ++_taken == _file_names.size();
+    lock.unlock();
+    _taken_cv.notify_one();
+    if (last) {
+        // the other consumers stop waiting
+        _read_cv.notify_all();
+    }
+
+    index = file.index;
+    if (file.error) {
+        std::rethrow_exception(file.error);
+    }
+    contents = std::move(file.contents);
+    return true;
+}
+
+size_t FileBatchReader::getSize() const {
+    return _file_names.size();
+}
+
+bool FileBatchReader::usesIoUring() const {
+    return _ring != nullptr;
+}
@@ -1,135 +1,619 @@
 #include "../include/lexer/lexer-contaner.h"
 
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
 using namespace lexer;
 
-void LexerContaner::_countSize() {
-    _size = 0;
-    for (auto& tl : _contaner) {
-        _size += tl.tokens.size();
+template <class CharT>
+const typename BasicLexerContaner<CharT>::lines_t&
+BasicLexerContaner<CharT>::_lines() const {
+    std::shared_ptr<const lines_t> lines = _contaner.load(std::memory_order_acquire);
+    if (lines) {
+        return *lines;
+    }
+    // the other threads wait for the rows instead of building them again
+    std::lock_guard<std::mutex> lock(_contaner_mutex);
+    lines = _contaner.load(std::memory_order_acquire);
+    if (lines) {
+        return *lines;
+    }
+
+    auto built = std::allocate_shared<lines_t>(
+        std::pmr::polymorphic_allocator<lines_t>(getMemoryResource()));
+    string_view_t text = _text ? string_view_t(*_text) : string_view_t();
+    built->reserve(_line_numbers.size());
+    for (size_t i = 0, k = 0; i < _line_numbers.size(); ++i) {
+        line_t line;
+        line.line_number = _line_numbers[i];
+        line.original = string_t(text.substr(_original_offsets[i], _original_lengths[i]));
+        line.tokens.reserve(_line_ends[i] - k);
+        for (; k < _line_ends[i]; ++k) {
+            line.tokens.push_back(BasicToken<CharT>::makeView(_ids[k], getTokenText(k)));
+        }
+        built->push_back(std::move(line));
     }
+    _contaner.store(built, std::memory_order_release);
+    return *built;
 }
 
-LexerContaner::LexerContaner() : _size(0) {}
+template <class CharT>
+void BasicLexerContaner<CharT>::_appendLines(const contaner_t& contaner) {
+    string_t text;
+    _ids.clear();
+    _offsets.clear();
+    _lengths.clear();
+    _symbols.clear();
+    _interner.reset();
+    _line_ends.clear();
+    _line_numbers.clear();
+    _original_offsets.clear();
+    _original_lengths.clear();
+    for (const line_t& line : contaner) {
+        for (const BasicToken<CharT>& token : line.tokens) {
+            _ids.push_back(token.getId());
+            _offsets.push_back(text.size());
+            _lengths.push_back(token.getText().size());
+            text.append(token.getText());
+        }
+        _line_ends.push_back(_ids.size());
+        _line_numbers.push_back(line.line_number);
+        _original_offsets.push_back(text.size());
+        _original_lengths.push_back(line.original.size());
+        text.append(line.original);
+    }
+    _text = std::make_shared<const string_t>(std::move(text));
+    _is_source = false;
+    _contaner.store(nullptr);
+}
 
-LexerContaner::LexerContaner(const LexerContaner& other) :
-    _contaner(other._contaner),
-    _size(other._size) {}
+template <class CharT>
+BasicLexerContaner<CharT>::BasicLexerContaner() :
+    BasicLexerContaner(std::pmr::get_default_resource()) {}
 
-LexerContaner::LexerContaner(LexerContaner&& other) noexcept :
-    _contaner(std::move(other._contaner)),
-    _size(other._size) {
-    other._size = 0;
-}
+template <class CharT>
+BasicLexerContaner<CharT>::BasicLexerContaner(std::pmr::memory_resource* resource) :
+    _is_source(false),
+    _ids(resource),
+    _offsets(resource),
+    _lengths(resource),
+    _symbols(resource),
+    _line_ends(resource),
+    _line_numbers(resource),
+    _original_offsets(resource),
+    _original_lengths(resource) {}
 
-LexerContaner::LexerContaner(const lexer_contaner_t& contaner) :
-    _contaner(contaner),
-    _size(0) {
-    _countSize();
+template <class CharT>
+BasicLexerContaner<CharT>::BasicLexerContaner(const BasicLexerContaner& other) :
+    _text(other._text),
+    _is_source(other._is_source),
+    _ids(other._ids),
+    _offsets(other._offsets),
+    _lengths(other._lengths),
+    _symbols(other._symbols),
+    _interner(other._interner),
+    _line_ends(other._line_ends),
+    _line_numbers(other._line_numbers),
+    _original_offsets(other._original_offsets),
+    _original_lengths(other._original_lengths) {}
+
+template <class CharT>
+BasicLexerContaner<CharT>::BasicLexerContaner(BasicLexerContaner&& other) noexcept :
+    _text(std::move(other._text)),
+    _is_source(other._is_source),
+    _ids(std::move(other._ids)),
+    _offsets(std::move(other._offsets)),
+    _lengths(std::move(other._lengths)),
+    _symbols(std::move(other._symbols)),
+    _interner(std::move(other._interner)),
+    _line_ends(std::move(other._line_ends)),
+    _line_numbers(std::move(other._line_numbers)),
+    _original_offsets(std::move(other._original_offsets)),
+    _original_lengths(std::move(other._original_lengths)),
+    _contaner(other._contaner.exchange(nullptr)) {}
+
+template <class CharT>
+BasicLexerContaner<CharT>::BasicLexerContaner(const contaner_t& contaner) :
+    _is_source(false) {
+    _appendLines(contaner);
 }
 
-LexerContaner::LexerContaner(lexer_contaner_t&& contaner) :
-    _contaner(std::move(contaner)),
-    _size(0) {
-    _countSize();
+template <class CharT>
+BasicLexerContaner<CharT>::BasicLexerContaner(contaner_t&& contaner) : _is_source(false) {
+    _appendLines(contaner);
 }
 
-LexerContaner& LexerContaner::operator=(const LexerContaner& other) {
-    _contaner = other._contaner;
-    _size = other._size;
+template <class CharT>
+BasicLexerContaner<CharT>&
+BasicLexerContaner<CharT>::operator=(const BasicLexerContaner& other) {
+    if (this != &other) {
+        _text = other._text;
+        _is_source = other._is_source;
+        _ids = other._ids;
+        _offsets = other._offsets;
+        _lengths = other._lengths;
+        _symbols = other._symbols;
+        _interner = other._interner;
+        _line_ends = other._line_ends;
+        _line_numbers = other._line_numbers;
+        _original_offsets = other._original_offsets;
+        _original_lengths = other._original_lengths;
+        _contaner.store(nullptr);
+    }
     return *this;
 }
 
-LexerContaner& LexerContaner::operator=(LexerContaner&& other) noexcept {
-    _contaner = std::move(other._contaner);
-    _size = other._size;
-    other._size = 0;
+template <class CharT>
+BasicLexerContaner<CharT>&
+BasicLexerContaner<CharT>::operator=(BasicLexerContaner&& other) noexcept {
+    if (this != &other) {
+        _text = std::move(other._text);
+        _is_source = other._is_source;
+        _ids = std::move(other._ids);
+        _offsets = std::move(other._offsets);
+        _lengths = std::move(other._lengths);
+        _symbols = std::move(other._symbols);
+        _interner = std::move(other._interner);
+        _line_ends = std::move(other._line_ends);
+        _line_numbers = std::move(other._line_numbers);
+        _original_offsets = std::move(other._original_offsets);
+        _original_lengths = std::move(other._original_lengths);
+        _contaner.store(other._contaner.exchange(nullptr));
+    }
     return *this;
 }
 
-LexerContaner& lexer::LexerContaner::operator=(const lexer_contaner_t& contaner) {
-    _contaner = contaner;
-    _countSize();
+template <class CharT>
+BasicLexerContaner<CharT>&
+BasicLexerContaner<CharT>::operator=(const contaner_t& contaner) {
+    _appendLines(contaner);
     return *this;
 }
 
-LexerContaner& lexer::LexerContaner::operator=(lexer_contaner_t&& contaner) noexcept {
-    _contaner = std::move(contaner);
-    _countSize();
+template <class CharT>
+BasicLexerContaner<CharT>&
+BasicLexerContaner<CharT>::operator=(contaner_t&& contaner) {
+    _appendLines(contaner);
     return *this;
 }
 
-LexerIterator LexerContaner::begin() {
-    return LexerIterator(_contaner);
+template <class CharT>
+typename BasicLexerContaner<CharT>::iterator BasicLexerContaner<CharT>::begin() {
+    return iterator(*this);
+}
+
+template <class CharT>
+typename
+BasicLexerContaner<CharT>::const_iterator BasicLexerContaner<CharT>::begin() const {
+    return const_iterator(*this);
+}
+
+template <class CharT>
+typename BasicLexerContaner<CharT>::const_iterator
+BasicLexerContaner<CharT>::cbegin() const {
+    return const_iterator(*this);
+}
+
+template <class CharT>
+typename BasicLexerContaner<CharT>::iterator BasicLexerContaner<CharT>::end() {
+    return iterator(*this, getSize());
+}
+
+template <class CharT>
+typename
+BasicLexerContaner<CharT>::const_iterator BasicLexerContaner<CharT>::end() const {
+    return const_iterator(*this, getSize());
+}
+
+template <class CharT>
+typename
+BasicLexerContaner<CharT>::const_iterator BasicLexerContaner<CharT>::cend() const {
+    return const_iterator(*this, getSize());
+}
+
+template <class CharT>
+typename BasicLexerContaner<CharT>::reverse_iterator BasicLexerContaner<CharT>::rbegin() {
+    return reverse_iterator(*this);
+}
+
+template <class CharT>
+typename BasicLexerContaner<CharT>::const_reverse_iterator
+BasicLexerContaner<CharT>::rbegin() const {
+    return const_reverse_iterator(*this);
 }
 
-LexerConstIterator LexerContaner::begin() const {
-    return LexerConstIterator(_contaner);
+template <class CharT>
+typename BasicLexerContaner<CharT>::const_reverse_iterator
+BasicLexerContaner<CharT>::crbegin() const {
+    return const_reverse_iterator(*this);
 }
 
-LexerConstIterator LexerContaner::cbegin() const {
-    return LexerConstIterator(_contaner);
+template <class CharT>
+typename BasicLexerContaner<CharT>::reverse_iterator BasicLexerContaner<CharT>::rend() {
+    return reverse_iterator(*this, getSize());
 }
 
-LexerIterator LexerContaner::end() {
-    return LexerIterator(_contaner) + _size;
+template <class CharT>
+typename BasicLexerContaner<CharT>::const_reverse_iterator
+BasicLexerContaner<CharT>::rend() const {
+    return const_reverse_iterator(*this, getSize());
 }
 
-LexerConstIterator LexerContaner::end() const {
-    return LexerConstIterator(_contaner) + _size;
+template <class CharT>
+typename BasicLexerContaner<CharT>::const_reverse_iterator
+BasicLexerContaner<CharT>::crend() const {
+    return const_reverse_iterator(*this, getSize());
 }
 
-LexerConstIterator LexerContaner::cend() const {
-    return LexerConstIterator(_contaner) + _size;
+template <class CharT>
+std::ranges::subrange<typename BasicLexerContaner<CharT>::unchecked_iterator>
+BasicLexerContaner<CharT>::unchecked() const {
+    return { unchecked_iterator(*this), unchecked_iterator(*this, getSize()) };
 }
 
-LexerReverseIterator LexerContaner::rbegin() {
-    return LexerReverseIterator(_contaner);
+template <class CharT>
+const typename BasicLexerContaner<CharT>::line_t&
+BasicLexerContaner<CharT>::getLine(size_t i) const {
+    return _lines().at(i);
 }
 
-LexerConstReverseIterator LexerContaner::rbegin() const {
-    return LexerConstReverseIterator(_contaner);
+template <class CharT>
+const typename BasicLexerContaner<CharT>::line_t&
+BasicLexerContaner<CharT>::operator[](size_t i) const {
+    return _lines()[i];
 }
 
-LexerConstReverseIterator LexerContaner::crbegin() const {
-    return LexerConstReverseIterator(_contaner);
+template <class CharT>
+std::span<const uint64_t> BasicLexerContaner<CharT>::getIds() const {
+    return _ids;
 }
 
-LexerReverseIterator LexerContaner::rend() {
-    return LexerReverseIterator(_contaner) + _size;
+template <class CharT>
+std::span<const typename BasicLexerContaner<CharT>::symbol_t>
+BasicLexerContaner<CharT>::getSymbols() const {
+    return _symbols;
 }
 
-LexerConstReverseIterator LexerContaner::rend() const {
-    return LexerConstReverseIterator(_contaner) + _size;
+template <class CharT>
+std::shared_ptr<const typename BasicLexerContaner<CharT>::interner_t>
+BasicLexerContaner<CharT>::getInterner() const {
+    return _interner;
 }
 
-LexerConstReverseIterator LexerContaner::crend() const {
-    return LexerConstReverseIterator(_contaner) + _size;
+template <class CharT>
+std::span<const uint64_t> BasicLexerContaner<CharT>::getLineIds(size_t i) const {
+    size_t start = i == 0 ? 0 : _line_ends.at(i - 1);
+    return std::span<const uint64_t>(_ids).subspan(start, _line_ends.at(i) - start);
 }
 
-TokenLine& LexerContaner::getLine(size_t i) {
-    return _contaner.at(i);
+template <class CharT>
+typename BasicLexerContaner<CharT>::string_view_t
+BasicLexerContaner<CharT>::getTokenText(size_t i) const {
+    return string_view_t(*_text).substr(_offsets.at(i), _lengths[i]);
 }
 
-const TokenLine& LexerContaner::getLine(size_t i) const {
-    return _contaner.at(i);
+template <class CharT>
+typename BasicLexerContaner<CharT>::token_t
+BasicLexerContaner<CharT>::tokenAt(size_t i) const {
+    return token_t::makeView(_ids.at(i), getTokenText(i));
 }
 
-TokenLine& LexerContaner::operator[](size_t i) {
-    return _contaner[i];
+template <class CharT>
+std::pair<size_t, size_t> BasicLexerContaner<CharT>::locateToken(size_t i) const {
+    if (i >= getSize()) {
+        throw std::out_of_range("no more tokens");
+    }
+    // the first row that ends after the token
+    size_t line = static_cast<size_t>(
+        std::upper_bound(_line_ends.begin(), _line_ends.end(), i) - _line_ends.begin());
+    return { line, i - getLineStart(line) };
+}
+
+template <class CharT> size_t BasicLexerContaner<CharT>::getLineStart(size_t i) const {
+    if (i > _line_ends.size()) {
+        throw std::out_of_range("no such row");
+    }
+    return i == 0 ? 0 : _line_ends[i - 1];
 }
 
-const TokenLine& LexerContaner::operator[](size_t i) const {
-    return _contaner[i];
+template <class CharT>
+typename BasicLexerContaner<CharT>::view_t
+BasicLexerContaner<CharT>::getRange(size_t first, size_t last) const {
+    return view_t(*this, first, last);
 }
 
-size_t LexerContaner::getSize() const {
-    return _size;
+template <class CharT>
+typename BasicLexerContaner<CharT>::view_t
+BasicLexerContaner<CharT>::getLineRange(size_t first, size_t last) const {
+    return view_t(*this, getLineStart(first), getLineStart(last));
 }
 
-size_t LexerContaner::getTokensNumber() const {
+template <class CharT>
+std::vector<BasicLexerContanerView<CharT>>
+BasicLexerContaner<CharT>::partition(size_t n, bool whole_lines) const {
+    if (n == 0) {
+        n = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    std::vector<view_t> views;
+    views.reserve(n);
+    size_t size = getSize();
+    size_t first = 0;
+    for (size_t i = 1; i <= n; ++i) {
+        // size * i / n without overflow
+        size_t last = size / n * i + size % n * i / n;
+        if (whole_lines && i < n) {
+            auto end = std::lower_bound(_line_ends.begin(), _line_ends.end(), last);
+            size_t after = end == _line_ends.end() ? size : *end;
+            size_t before = end == _line_ends.begin() ? 0 : *(end - 1);
+            last = std::max(last - before <= after - last ? before : after, first);
+        }
+        views.push_back(view_t(*this, first, last));
+        first = last;
+    }
+    return views;
+}
+
+template <class CharT> size_t BasicLexerContaner<CharT>::getLineNumber(size_t i) const {
+    return _line_numbers.at(i);
+}
+
+template <class CharT>
+typename BasicLexerContaner<CharT>::string_view_t
+BasicLexerContaner<CharT>::getOriginal(size_t i) const {
+    return string_view_t(*_text).substr(_original_offsets.at(i), _original_lengths[i]);
+}
+
+template <class CharT> size_t BasicLexerContaner<CharT>::countId(uint64_t id) const {
+    return static_cast<size_t>(std::count(_ids.begin(), _ids.end(), id));
+}
+
+template <class CharT> size_t BasicLexerContaner<CharT>::getSize() const {
+    return _ids.size();
+}
+
+template <class CharT> size_t BasicLexerContaner<CharT>::getTokensNumber() const {
     return getSize();
 }
 
-size_t LexerContaner::getLinesNumber() const {
-    return _contaner.size();
+template <class CharT> size_t BasicLexerContaner<CharT>::getLinesNumber() const {
+    return _line_numbers.size();
+}
+
+template <class CharT>
+typename BasicLexerContaner<CharT>::string_view_t
+BasicLexerContaner<CharT>::getSource() const {
+    return _is_source && _text ? string_view_t(*_text) : string_view_t();
+}
+
+template <class CharT>
+std::pmr::memory_resource* BasicLexerContaner<CharT>::getMemoryResource() const {
+    return _ids.get_allocator().resource();
+}
+
+template <class CharT>
+BasicLexerContanerView<CharT>::BasicLexerContanerView() :
+    _contaner(nullptr), _first(0), _last(0) {}
+
+template <class CharT>
+BasicLexerContanerView<CharT>::BasicLexerContanerView(const contaner_t& contaner,
+                                                      size_t first, size_t last) :
+    _contaner(&contaner), _first(first), _last(last) {
+    if (first > last || last > contaner.getSize()) {
+        throw std::out_of_range("no such tokens");
+    }
+}
+
+template <class CharT>
+typename BasicLexerContanerView<CharT>::const_iterator
+BasicLexerContanerView<CharT>::begin() const {
+    if (_contaner == nullptr) {
+        return const_iterator();
+    }
+    return const_iterator(*_contaner, _first);
+}
+
+template <class CharT>
+typename BasicLexerContanerView<CharT>::const_iterator
+BasicLexerContanerView<CharT>::end() const {
+    if (_contaner == nullptr) {
+        return const_iterator();
+    }
+    return const_iterator(*_contaner, _last);
+}
+
+template <class CharT>
+typename BasicLexerContanerView<CharT>::token_t
+BasicLexerContanerView<CharT>::tokenAt(size_t i) const {
+    if (i >= getSize()) {
+        throw std::out_of_range("no more tokens");
+    }
+    return _contaner->tokenAt(_first + i);
+}
+
+template <class CharT>
+std::span<const uint64_t> BasicLexerContanerView<CharT>::getIds() const {
+    if (_contaner == nullptr) {
+        return {};
+    }
+    return std::span<const uint64_t>(_contaner->_ids).subspan(_first, _last - _first);
+}
+
+template <class CharT> size_t BasicLexerContanerView<CharT>::getSize() const {
+    return _last - _first;
+}
+
+template <class CharT> size_t BasicLexerContanerView<CharT>::getBeginIndex() const {
+    return _first;
+}
+
+template <class CharT> size_t BasicLexerContanerView<CharT>::getEndIndex() const {
+    return _last;
+}
+
+template <class CharT>
+BasicLexerContanerBuilder<CharT>::BasicLexerContanerBuilder(
+    source_t source, std::shared_ptr<interner_t> interner,
+    std::pmr::memory_resource* resource) :
+    _contaner(resource != nullptr ? resource : std::pmr::get_default_resource()),
+    _interner(std::move(interner)) {
+    _contaner._is_source = source != nullptr;
+    _contaner._text = std::move(source);
+    _contaner._interner = _interner;
+}
+
+template <class CharT>
+size_t BasicLexerContanerBuilder<CharT>::appendText(string_view_t text) {
+    size_t offset = _text.size();
+    _text.append(text);
+    return offset;
+}
+
+template <class CharT>
+typename BasicLexerContanerBuilder<CharT>::string_view_t
+BasicLexerContanerBuilder<CharT>::getCopy(size_t offset) const {
+    return string_view_t(_text).substr(offset);
+}
+
+template <class CharT>
+void BasicLexerContanerBuilder<CharT>::addToken(uint64_t id, size_t offset,
+                                                size_t length) {
+    _contaner._ids.push_back(id);
+    _contaner._offsets.push_back(offset);
+    _contaner._lengths.push_back(length);
+    if (_interner) {
+        // the id of the token is the hash of its text
+        string_view_t text = _contaner._text ? string_view_t(*_contaner._text)
+                                             : string_view_t(_text);
+        _contaner._symbols.push_back(_interner->intern(text.substr(offset, length), id));
+    }
+}
+
+template <class CharT> bool BasicLexerContanerBuilder<CharT>::isLineEmpty() const {
+    size_t line_start = _contaner._line_ends.empty() ? 0 : _contaner._line_ends.back();
+    return _contaner._ids.size() == line_start;
+}
+
+template <class CharT>
+size_t BasicLexerContanerBuilder<CharT>::getTokensNumber() const {
+    return _contaner._ids.size();
+}
+
+template <class CharT>
+size_t BasicLexerContanerBuilder<CharT>::getLinesNumber() const {
+    return _contaner._line_ends.size();
 }
+
+template <class CharT>
+void BasicLexerContanerBuilder<CharT>::append(std::span<const Part> parts,
+                                              size_t threads) {
+    contaner_t& to = _contaner;
+    // the places of the parts in the storage
+    std::vector<size_t> token_starts, line_starts;
+    const size_t old_tokens = to._ids.size();
+    size_t tokens = old_tokens, lines = to._line_ends.size();
+    for (const Part& part : parts) {
+        token_starts.push_back(tokens);
+        line_starts.push_back(lines);
+        tokens += part.builder->_contaner._ids.size() - part.first_token;
+        lines += part.builder->_contaner._line_ends.size() - part.first_line;
+    }
+    to._ids.resize(tokens);
+    to._offsets.resize(tokens);
+    to._lengths.resize(tokens);
+    to._line_ends.resize(lines);
+    to._line_numbers.resize(lines);
+    to._original_offsets.resize(lines);
+    to._original_lengths.resize(lines);
+    if (_interner) {
+        to._symbols.resize(tokens);
+    }
+
+    std::atomic<size_t> next_part = 0;
+    auto copyParts = [&]() {
+        for (size_t p = next_part++; p < parts.size(); p = next_part++) {
+            const Part& part = parts[p];
+            const contaner_t& from = part.builder->_contaner;
+            const size_t first = part.first_token;
+            std::copy(from._ids.begin() + first, from._ids.end(),
+                      to._ids.begin() + token_starts[p]);
+            std::copy(from._offsets.begin() + first, from._offsets.end(),
+                      to._offsets.begin() + token_starts[p]);
+            std::copy(from._lengths.begin() + first, from._lengths.end(),
+                      to._lengths.begin() + token_starts[p]);
+            const size_t token_shift = token_starts[p] - first;
+            size_t k = line_starts[p];
+            for (size_t i = part.first_line; i < from._line_ends.size(); ++i, ++k) {
+                to._line_ends[k] = from._line_ends[i] + token_shift;
+                to._line_numbers[k] = from._line_numbers[i] + part.line_shift;
+                to._original_offsets[k] = from._original_offsets[i];
+                to._original_lengths[k] = from._original_lengths[i];
+            }
+            if (_interner) {
+                // the texts that are already interned are found without a lock
+                string_view_t text(*to._text);
+                const size_t end = token_starts[p] + from._ids.size() - first;
+                for (size_t k = token_starts[p]; k < end; ++k) {
+                    to._symbols[k] =
+                        _interner->find(text.substr(to._offsets[k], to._lengths[k]),
+                                        to._ids[k]);
+                }
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < std::min(threads, parts.size()); ++i) {
+        workers.emplace_back(copyParts);
+    }
+    copyParts();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    if (_interner) {
+        // the new texts are interned in the order of the tokens, so the ids are the
+        // same as the ones of one thread
+        string_view_t text(*to._text);
+        for (size_t k = old_tokens; k < tokens; ++k) {
+            if (to._symbols[k] == interner_t::NO_SYMBOL) {
+                string_view_t token_text = text.substr(to._offsets[k], to._lengths[k]);
+                to._symbols[k] = _interner->intern(token_text, to._ids[k]);
+            }
+        }
+    }
+}
+
+template <class CharT>
+void BasicLexerContanerBuilder<CharT>::endLine(size_t line_number, size_t offset,
+                                               size_t length) {
+    if (isLineEmpty()) {
+        return;
+    }
+    _contaner._line_ends.push_back(_contaner._ids.size());
+    _contaner._line_numbers.push_back(line_number);
+    _contaner._original_offsets.push_back(offset);
+    _contaner._original_lengths.push_back(length);
+}
+
+template <class CharT>
+BasicLexerContaner<CharT> BasicLexerContanerBuilder<CharT>::build() {
+    if (!_contaner._text) {
+        _contaner._text = std::make_shared<const string_t>(std::move(_text));
+    }
+    return std::move(_contaner);
+}
+
+template class lexer::BasicLexerContaner<char>;
+template class lexer::BasicLexerContaner<char8_t>;
+template class lexer::BasicLexerContaner<char16_t>;
+template class lexer::BasicLexerContaner<wchar_t>;
+
+template class lexer::BasicLexerContanerView<char>;
+template class lexer::BasicLexerContanerView<char8_t>;
+template class lexer::BasicLexerContanerView<char16_t>;
+template class lexer::BasicLexerContanerView<wchar_t>;
+
+template class lexer::BasicLexerContanerBuilder<char>;
+template class lexer::BasicLexerContanerBuilder<char8_t>;
+template class lexer::BasicLexerContanerBuilder<char16_t>;
+template class lexer::BasicLexerContanerBuilder<wchar_t>;
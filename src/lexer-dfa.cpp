@@ -0,0 +1,156 @@
+#include "../include/lexer/lexer-dfa.h"
+
+#include <algorithm>
+#include <thread>
+
+using namespace lexer;
+
+LexerDfa::LexerDfa() : LexerDfa({}, L"", {}, L"") {}
+
+LexerDfa::LexerDfa(const std::vector<std::wstring>& special_alphabets,
+                   const std::wstring& individual_chars,
+                   const std::vector<CombiningTokens>& combining_tokens,
+                   const std::wstring& separators) {
+    std::vector<std::wstring_view> alphabet_views(special_alphabets.begin(),
+                                                  special_alphabets.end());
+    std::vector<DfaBuilder::combining_view_t> combining_views;
+    for (const CombiningTokens& combining_token : combining_tokens) {
+        combining_views.push_back(
+            { combining_token.start.getText(), combining_token.end.getText() });
+    }
+    DfaTables tables = DfaBuilder::build(alphabet_views, individual_chars,
+                                         combining_views, separators);
+
+    _char_classes.clear(0);
+    for (const auto& [c, char_class] : tables.char_classes) {
+        _char_classes.set(c, char_class);
+    }
+    _classes_number = tables.classes_number;
+    _transitions = std::move(tables.transitions);
+    _first_region_state = tables.first_region_state;
+    _default_run_state = tables.default_run_state;
+    _closers = std::move(tables.closers);
+    _opener_sizes = std::move(tables.opener_sizes);
+    _opener_nodes = std::move(tables.opener_nodes);
+    _opener_transitions = std::move(tables.opener_transitions);
+    _ascii_only = tables.ascii_only;
+    _utf8_closers = std::move(tables.utf8_closers);
+    _utf8_opener_sizes = std::move(tables.utf8_opener_sizes);
+    _bmp_only = tables.bmp_only;
+    _utf16_closers = std::move(tables.utf16_closers);
+    _utf16_opener_sizes = std::move(tables.utf16_opener_sizes);
+    _quiet_chars = DfaScanner<LexerDfa>::quietChars(_char_classes);
+    _threads_number = 1;
+}
+
+size_t LexerDfa::getStatesNumber() const {
+    return _transitions.size() / _classes_number;
+}
+
+void LexerDfa::setSimdEnabled(bool enabled) {
+    _quiet_chars.setEnabled(enabled);
+}
+
+bool LexerDfa::isSimdEnabled() const {
+    return _quiet_chars.isEnabled();
+}
+
+void LexerDfa::setThreadsNumber(size_t threads) {
+    _threads_number =
+        threads == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : threads;
+}
+
+size_t LexerDfa::getThreadsNumber() const {
+    return _threads_number;
+}
+
+template <class CharT, class InputT>
+BasicLexerContaner<CharT>
+LexerDfa::createTokens(std::basic_string_view<InputT> str,
+                       const BasicTokenIdentifier<CharT>& tokenId,
+                       std::shared_ptr<BasicTokenInterner<CharT>> interner,
+                       std::pmr::memory_resource* resource) const {
+    return DfaScanner<LexerDfa>::scan<CharT>(*this, str, tokenId, nullptr,
+                                             std::move(interner), _threads_number,
+                                             resource);
+}
+
+template <class CharT>
+BasicLexerContaner<CharT>
+LexerDfa::createTokenViews(typename BasicLexerContaner<CharT>::source_t source,
+                           const BasicTokenIdentifier<CharT>& tokenId,
+                           std::shared_ptr<BasicTokenInterner<CharT>> interner,
+                           std::pmr::memory_resource* resource) const {
+    std::basic_string_view<CharT> str(*source);
+    if constexpr (std::is_same_v<CharT, char8_t>) {
+        return DfaScanner<LexerDfa>::scan<CharT>(*this, asChars(str), tokenId,
+                                                 std::move(source), std::move(interner),
+                                                 _threads_number, resource);
+    } else {
+        return DfaScanner<LexerDfa>::scan<CharT>(*this, str, tokenId, std::move(source),
+                                                 std::move(interner), _threads_number,
+                                                 resource);
+    }
+}
+
+LexerContaner LexerDfa::createTokens(const std::wstring& str,
+                                     const Token::define_id_func_t& defineTokenId) const {
+    return createTokens<wchar_t>(std::wstring_view(str),
+                                 TokenIdentifier(defineTokenId));
+}
+
+LexerContaner LexerDfa::createTokens(std::string_view str,
+                                     const Token::define_id_func_t& defineTokenId) const {
+    return createTokens<wchar_t>(str, TokenIdentifier(defineTokenId));
+}
+
+template BasicLexerContaner<char>
+LexerDfa::createTokens<char, char>(std::string_view, const BasicTokenIdentifier<char>&,
+                                   std::shared_ptr<BasicTokenInterner<char>>,
+                                   std::pmr::memory_resource*) const;
+template BasicLexerContaner<char8_t>
+LexerDfa::createTokens<char8_t, char>(std::string_view,
+                                      const BasicTokenIdentifier<char8_t>&,
+                                      std::shared_ptr<BasicTokenInterner<char8_t>>,
+                                      std::pmr::memory_resource*) const;
+template BasicLexerContaner<char16_t>
+LexerDfa::createTokens<char16_t, char>(
+    std::string_view, const BasicTokenIdentifier<char16_t>&,
+    std::shared_ptr<BasicTokenInterner<char16_t>>,
+    std::pmr::memory_resource*) const;
+template BasicLexerContaner<char16_t>
+LexerDfa::createTokens<char16_t, char16_t>(
+    std::u16string_view, const BasicTokenIdentifier<char16_t>&,
+    std::shared_ptr<BasicTokenInterner<char16_t>>,
+    std::pmr::memory_resource*) const;
+template BasicLexerContaner<wchar_t>
+LexerDfa::createTokens<wchar_t, char>(std::string_view,
+                                      const BasicTokenIdentifier<wchar_t>&,
+                                      std::shared_ptr<BasicTokenInterner<wchar_t>>,
+                                      std::pmr::memory_resource*) const;
+template BasicLexerContaner<wchar_t>
+LexerDfa::createTokens<wchar_t, wchar_t>(
+    std::wstring_view, const BasicTokenIdentifier<wchar_t>&,
+    std::shared_ptr<BasicTokenInterner<wchar_t>>,
+    std::pmr::memory_resource*) const;
+
+template BasicLexerContaner<char>
+LexerDfa::createTokenViews<char>(BasicLexerContaner<char>::source_t,
+                                 const BasicTokenIdentifier<char>&,
+                                 std::shared_ptr<BasicTokenInterner<char>>,
+                                 std::pmr::memory_resource*) const;
+template BasicLexerContaner<char8_t>
+LexerDfa::createTokenViews<char8_t>(BasicLexerContaner<char8_t>::source_t,
+                                    const BasicTokenIdentifier<char8_t>&,
+                                    std::shared_ptr<BasicTokenInterner<char8_t>>,
+                                    std::pmr::memory_resource*) const;
+template BasicLexerContaner<char16_t>
+LexerDfa::createTokenViews<char16_t>(BasicLexerContaner<char16_t>::source_t,
+                                     const BasicTokenIdentifier<char16_t>&,
+                                     std::shared_ptr<BasicTokenInterner<char16_t>>,
+                                     std::pmr::memory_resource*) const;
+template BasicLexerContaner<wchar_t>
+LexerDfa::createTokenViews<wchar_t>(BasicLexerContaner<wchar_t>::source_t,
+                                    const BasicTokenIdentifier<wchar_t>&,
+                                    std::shared_ptr<BasicTokenInterner<wchar_t>>,
+                                    std::pmr::memory_resource*) const;
@@ -1,31 +1,48 @@
 #include "../include/lexer/lexer-iterator.h"
+#include "../include/lexer/lexer-contaner.h"
 
 using namespace lexer;
 
-LexerIterator::LexerIterator(contaner& c) :
-    LexerTemplateIterator(c.begin(), c.end(), c.begin()->tokens.begin()) {}
-
-LexerIterator::token_it_t LexerIterator::getBegin() {
-    return _current_line->tokens.begin();
-}
-
-LexerConstIterator::LexerConstIterator(const contaner& c) :
-    LexerTemplateIterator(c.cbegin(), c.cend(), c.cbegin()->tokens.cbegin()) {}
-
-LexerConstIterator::token_it_t LexerConstIterator::getBegin() {
-    return _current_line->tokens.cbegin();
-}
-
-LexerReverseIterator::LexerReverseIterator(contaner& c) :
-    LexerTemplateIterator(c.rbegin(), c.rend(), c.rbegin()->tokens.rbegin()) {}
-
-LexerReverseIterator::token_it_t LexerReverseIterator::getBegin() {
-    return _current_line->tokens.rbegin();
-}
-
-LexerConstReverseIterator::LexerConstReverseIterator(const contaner& c) :
-    LexerTemplateIterator(c.crbegin(), c.crend(), c.crbegin()->tokens.crbegin()) {}
-
-LexerConstReverseIterator::token_it_t LexerConstReverseIterator::getBegin() {
-    return _current_line->tokens.crbegin();
-}
+template <class CharT>
+BasicLexerIterator<CharT>::BasicLexerIterator(const contaner& c, size_t index) :
+    base_t(c, index) {}
+
+template <class CharT, bool Checked>
+BasicLexerConstIterator<CharT, Checked>::BasicLexerConstIterator(const contaner& c,
+                                                                 size_t index) :
+    base_t(c, index) {}
+
+template <class CharT>
+BasicLexerReverseIterator<CharT>::BasicLexerReverseIterator(const contaner& c,
+                                                            size_t index) :
+    base_t(c, index) {}
+
+template <class CharT>
+BasicLexerConstReverseIterator<CharT>::BasicLexerConstReverseIterator(const contaner& c,
+                                                                      size_t index) :
+    base_t(c, index) {}
+
+template class lexer::BasicLexerIterator<char>;
+template class lexer::BasicLexerIterator<char8_t>;
+template class lexer::BasicLexerIterator<char16_t>;
+template class lexer::BasicLexerIterator<wchar_t>;
+
+template class lexer::BasicLexerConstIterator<char>;
+template class lexer::BasicLexerConstIterator<char8_t>;
+template class lexer::BasicLexerConstIterator<char16_t>;
+template class lexer::BasicLexerConstIterator<wchar_t>;
+
+template class lexer::BasicLexerConstIterator<char, false>;
+template class lexer::BasicLexerConstIterator<char8_t, false>;
+template class lexer::BasicLexerConstIterator<char16_t, false>;
+template class lexer::BasicLexerConstIterator<wchar_t, false>;
+
+template class lexer::BasicLexerReverseIterator<char>;
+template class lexer::BasicLexerReverseIterator<char8_t>;
+template class lexer::BasicLexerReverseIterator<char16_t>;
+template class lexer::BasicLexerReverseIterator<wchar_t>;
+
+template class lexer::BasicLexerConstReverseIterator<char>;
+template class lexer::BasicLexerConstReverseIterator<char8_t>;
+template class lexer::BasicLexerConstReverseIterator<char16_t>;
+template class lexer::BasicLexerConstReverseIterator<wchar_t>;
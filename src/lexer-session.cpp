@@ -0,0 +1,101 @@
+#include "../include/lexer/lexer-session.h"
+
+#include <stdexcept>
+
+using namespace lexer;
+
+template <class CharT>
+void BasicLexerSession<CharT>::_Sink::push(size_t from, size_t to, size_t line_number,
+                                           size_t) {
+    string_view_t text = string_view_t(session->_buffer).substr(from, to - from);
+    session->_callback(
+        stream_token_t { token_t::makeView(session->_token_id(text), text), line_number,
+                         session->_buffer_offset + from - session->_line_start });
+}
+
+template <class CharT>
+size_t BasicLexerSession<CharT>::_Sink::pushBody(size_t from, size_t to,
+                                                 size_t line_number, size_t) {
+    // the body is hashed in the pass that counts its lines
+    string_view_t body = string_view_t(session->_buffer).substr(from, to - from);
+    size_t lines = 0;
+    uint64_t id = session->_token_id.identifyCountingLines(body, lines);
+    if (to > from) {
+        session->_callback(
+            stream_token_t { token_t::makeView(id, body), line_number,
+                             session->_buffer_offset + from - session->_line_start });
+    }
+    return lines;
+}
+
+template <class CharT>
+void BasicLexerSession<CharT>::_Sink::endLine(size_t, size_t, size_t to) {
+    session->_line_start = session->_buffer_offset + to;
+}
+
+template <class CharT> void BasicLexerSession<CharT>::_run() {
+    if constexpr (std::is_same_v<CharT, char8_t>) {
+        _cursor.str = asChars(string_view_t(_buffer));
+    } else {
+        _cursor.str = _buffer;
+    }
+    _Sink sink { this };
+    DfaScanner<LexerDfa>::run(*_dfa, _cursor, sink);
+    if (_cursor.finished) {
+        return;
+    }
+
+    // the text before the needed one is dropped when it is at least a half of the
+    // buffer, so that a long token is not moved on every piece
+    size_t needed = DfaScanner<LexerDfa>::neededStart(*_dfa, _cursor);
+    if (needed > 0 && needed * 2 >= _buffer.size()) {
+        _buffer.erase(0, needed);
+        _buffer_offset += needed;
+        _cursor.dropPrefix(needed);
+    }
+}
+
+template <class CharT>
+BasicLexerSession<CharT>::BasicLexerSession(const LexerDfa& dfa,
+                                            token_callback_t callback,
+                                            BasicTokenIdentifier<CharT> token_id) :
+    _dfa(&dfa),
+    _token_id(std::move(token_id)),
+    _callback(std::move(callback)),
+    _buffer_offset(0),
+    _line_start(0) {
+    _cursor.last = false;
+}
+
+template <class CharT> void BasicLexerSession<CharT>::feed(const CharT* chunk, size_t n) {
+    feed(string_view_t(chunk, n));
+}
+
+template <class CharT> void BasicLexerSession<CharT>::feed(string_view_t chunk) {
+    if (_cursor.finished) {
+        throw std::runtime_error("the session is finished");
+    }
+    _buffer.append(chunk);
+    // the bitmaps of the last block may lack the new characters
+    _cursor.block_start = SIZE_MAX;
+    _run();
+}
+
+template <class CharT> void BasicLexerSession<CharT>::finish() {
+    if (_cursor.finished) {
+        return;
+    }
+    _cursor.last = true;
+    _cursor.block_start = SIZE_MAX;
+    _run();
+    _buffer.clear();
+}
+
+template <class CharT> bool BasicLexerSession<CharT>::isFinished() const {
+    return _cursor.finished;
+}
+
+template class lexer::BasicLexerSession<char>;
+template class lexer::BasicLexerSession<char8_t>;
+template class lexer::BasicLexerSession<char16_t>;
+template class lexer::BasicLexerSession<wchar_t>;
@@ -0,0 +1,79 @@
+#include "../include/lexer/lexer-stream.h"
+
+#include <algorithm>
+
+using namespace lexer;
+
+template <class CharT>
+void BasicLexerStream<CharT>::_Sink::push(size_t from, size_t to, size_t line_number,
+                                          size_t line_start) {
+    string_view_t text = stream->_str.substr(from, to - from);
+    stream->_tokens.push_back(stream_token_t { token_t::makeView(stream->_token_id(text),
+                                                                 text),
+                                               line_number, from - line_start });
+}
+
+template <class CharT>
+size_t BasicLexerStream<CharT>::_Sink::pushBody(size_t from, size_t to,
+                                                size_t line_number, size_t line_start) {
+    // the body is hashed in the pass that counts its lines
+    string_view_t body = stream->_str.substr(from, to - from);
+    size_t lines = 0;
+    uint64_t id = stream->_token_id.identifyCountingLines(body, lines);
+    if (to > from) {
+        stream->_tokens.push_back(stream_token_t { token_t::makeView(id, body),
+                                                   line_number, from - line_start });
+    }
+    return lines;
+}
+
+template <class CharT>
+BasicLexerStream<CharT>::BasicLexerStream(const LexerDfa& dfa, string_view_t str,
+                                          BasicTokenIdentifier<CharT> token_id) :
+    _dfa(&dfa),
+    _token_id(std::move(token_id)),
+    _str(str),
+    _ready(0) {
+    if constexpr (std::is_same_v<CharT, char8_t>) {
+        _cursor = cursor_t(asChars(str));
+    } else {
+        _cursor = cursor_t(str);
+    }
+}
+
+template <class CharT>
+bool BasicLexerStream<CharT>::nextToken(stream_token_t& token) {
+    if (_ready == _tokens.size()) {
+        // the automaton runs until it finds tokens, the buffer keeps only them
+        _tokens.clear();
+        _ready = 0;
+        _Sink sink { this };
+        while (_tokens.empty() && !_cursor.finished) {
+            DfaScanner<LexerDfa>::run(*_dfa, _cursor, sink);
+        }
+        if (_tokens.empty()) {
+            return false;
+        }
+    }
+    token = std::move(_tokens[_ready++]);
+    return true;
+}
+
+template <class CharT> bool BasicLexerStream<CharT>::isFinished() const {
+    return _cursor.finished && _ready == _tokens.size();
+}
+
+template <class CharT>
+typename BasicLexerStream<CharT>::Iterator BasicLexerStream<CharT>::begin() {
+    return Iterator(*this);
+}
+
+template <class CharT>
+typename BasicLexerStream<CharT>::Iterator BasicLexerStream<CharT>::end() {
+    return Iterator();
+}
+
+template class lexer::BasicLexerStream<char>;
+template class lexer::BasicLexerStream<char8_t>;
+template class lexer::BasicLexerStream<char16_t>;
+template class lexer::BasicLexerStream<wchar_t>;
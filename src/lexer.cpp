@@ -1,262 +1,518 @@
 #include "../include/lexer/lexer.h"
+#include "../include/lexer/delimiter-search.h"
+#include "../include/lexer/file-batch-reader.h"
+#include "../include/lexer/mapped-file.h"
+#include "../include/lexer/unicode.h"
+#include "../include/lexer/work-stealing-pool.h"
 
 #include <locale>
-#include <codecvt>
+#include <cstdint>
 #include <filesystem>
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <thread>
 
 using namespace lexer;
 
-std::vector<CombiningTokens>::iterator Lexer::_isCombiningToken(const Token& token) {
-    for (auto it = _combining_tokens.begin(); it != _combining_tokens.end(); ++it) {
-        if (it->start == token) {
-            return it;
+namespace {
+    // the numbers of the inputs from the largest to the smallest
+    template <class SizeOf> std::vector<size_t> sortBySize(size_t count, SizeOf sizeOf) {
+        std::vector<uintmax_t> sizes(count);
+        std::vector<size_t> order(count);
+        for (size_t i = 0; i < count; ++i) {
+            sizes[i] = sizeOf(i);
+            order[i] = i;
         }
+        std::stable_sort(order.begin(), order.end(),
+                         [&sizes](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+        return order;
     }
-    return _combining_tokens.end();
+}  // namespace
+
+template <class CharT>
+typename std::vector<BasicCombiningTokens<CharT>>::const_iterator
+BasicLexer<CharT>::_findCombiningToken(const _CurrentStats& current_stats,
+                                       bool only_glued) const {
+    // the whole token or its longest suffix of a special alphabet opens a combined text
+    const DfaOpenerNode& node = _dfa.getOpenerNode(current_stats.opener_node);
+    long opener = !only_glued && current_stats.opener_whole && node.opener >= 0
+                      ? node.opener
+                      : node.glued_opener;
+    return opener >= 0 ? _combining_tokens.begin() + opener : _combining_tokens.end();
 }
 
-void Lexer::_pushToken(_CurrentStats& current_stats) {
-    if (!current_stats.token_name.empty()) {
-        current_stats.token_line.tokens.push_back(
-            Token(_defineTokenId, std::move(current_stats.token_name)));
-        current_stats.token_name.clear();
-        auto last_token = _isCombiningToken(current_stats.token_line.tokens.back());
-        if (last_token != _combining_tokens.end()) {
-            if (_separators.find(current_stats.c) != std::wstring::npos) {
-                current_stats.token_name.push_back(current_stats.c);
-            }
-            _pushText(current_stats, last_token);
+template <class CharT>
+bool BasicLexer<CharT>::_continuesOpener(const _CurrentStats& current_stats) const {
+    // the longest suffix of the token that may still become an opener goes on with the
+    // character
+    LexerDfa::state_t node = current_stats.opener_node;
+    if (node == 0) {
+        return false;
+    }
+    size_t depth = _dfa.getOpenerNode(node).depth;
+    return _dfa.getOpenerNode(_dfa.stepOpener(node, current_stats.c)).depth == depth + 1;
+}
+
+template <class CharT>
+void BasicLexer<CharT>::_appendChar(_CurrentStats& current_stats) const {
+    if (current_stats.token_name.empty()) {
+        current_stats.token_start = current_stats.char_begin;
+        current_stats.token_id = TEXT_ID_BASIS<uint64_t>;
+        current_stats.opener_node = 0;
+        current_stats.opener_whole = true;
+    }
+    current_stats.token_name.append(current_stats.char_begin, current_stats.char_it);
+    current_stats.last_c = current_stats.c;
+    // the openers the token ends with are tracked by the automaton of the Dfa engine
+    LexerDfa::state_t node = current_stats.opener_node;
+    current_stats.opener_node = _dfa.stepOpener(node, current_stats.c);
+    size_t depth = _dfa.getOpenerNode(current_stats.opener_node).depth;
+    current_stats.opener_whole =
+        current_stats.opener_whole && depth == _dfa.getOpenerNode(node).depth + 1;
+    // the id is calculated while the token is read, not once more when it is pushed
+    if (_token_id.isIncremental()) {
+        for (auto it = current_stats.char_begin; it != current_stats.char_it; ++it) {
+            current_stats.token_id =
+                updateTextId<uint64_t, CharT>(current_stats.token_id, *it);
         }
     }
 }
 
-bool Lexer::_isCloseToken(_CurrentStats& current_stats,
-                          std::vector<CombiningTokens>::iterator& close_token) const {
-    auto rit_token = current_stats.token_name.rbegin();
-    auto close_token_text = close_token->end.getText();
-    auto rit_close_token = close_token_text.rbegin();
-    while (rit_token != current_stats.token_name.rend() &&
-           rit_close_token != close_token_text.rend()) {
-        if (*rit_token != *rit_close_token) {
-            return false;
+template <class CharT>
+void BasicLexer<CharT>::_pushTokenText(_CurrentStats& current_stats,
+                                       string_view_t text) const {
+    _pushTokenText(current_stats, text, _token_id(text));
+}
+
+template <class CharT>
+void BasicLexer<CharT>::_pushTokenText(_CurrentStats& current_stats, string_view_t text,
+                                       uint64_t id) const {
+    // the text is a part of the contents
+    current_stats.tokens.addToken(
+        id, text.data() - std::to_address(current_stats.begin_it), text.size());
+}
+
+template <class CharT>
+void BasicLexer<CharT>::_pushTokenName(_CurrentStats& current_stats) const {
+    // the token name is the text of the contents from token_start
+    string_view_t text(std::to_address(current_stats.token_start),
+                       current_stats.token_name.size());
+    _pushTokenText(current_stats, text,
+                   _token_id.isIncremental() ? current_stats.token_id : _token_id(text));
+    current_stats.token_name.clear();
+}
+
+template <class CharT>
+bool BasicLexer<CharT>::_pushToken(_CurrentStats& current_stats,
+                                   bool reread_char) const {
+    if (current_stats.token_name.empty()) {
+        return false;
+    }
+    auto combining_token = _findCombiningToken(current_stats, false);
+    if (combining_token == _combining_tokens.end()) {
+        _pushTokenName(current_stats);
+        return false;
+    }
+
+    // the text before a glued opener is a separate token
+    size_t start_size = combining_token->start.getText().size();
+    size_t prefix_size = current_stats.token_name.size() - start_size;
+    auto start_begin =
+        current_stats.token_start + static_cast<std::ptrdiff_t>(prefix_size);
+    current_stats.token_name.resize(prefix_size);
+    if (!current_stats.token_name.empty()) {
+        if (_token_id.isIncremental()) {
+            // the id was calculated for the whole name
+            current_stats.token_id = _token_id(current_stats.token_name);
         }
-        ++rit_token;
-        ++rit_close_token;
+        _pushTokenName(current_stats);
     }
+    _pushTokenText(current_stats,
+                   string_view_t(start_begin,
+                                 start_begin + static_cast<std::ptrdiff_t>(start_size)));
+    if (reread_char) {
+        // the current character is the first one of the combined text
+        current_stats.char_it = current_stats.char_begin;
+    }
+    _pushText(current_stats, combining_token);
     return true;
 }
 
-void Lexer::_pushText(_CurrentStats& current_stats,
-                      std::vector<CombiningTokens>::iterator& close_token) {
-    while (current_stats.char_it != current_stats.end_it) {
-        current_stats.c = *current_stats.char_it;
-        ++current_stats.char_it;
-        current_stats.token_name.push_back(current_stats.c);
-        current_stats.token_line.original.push_back(current_stats.c);
-        if (_isCloseToken(current_stats, close_token)) {
-            for (size_t i = 0; i < close_token->end.getText().size(); ++i) {
-                current_stats.token_name.pop_back();
-            }
-            if (!current_stats.token_name.empty()) {
-                current_stats.token_line.tokens.push_back(
-                    Token(_defineTokenId, std::move(current_stats.token_name)));
-            }
-            current_stats.token_name = close_token->end.getText();
-            current_stats.token_line.tokens.push_back(
-                Token(_defineTokenId, std::move(current_stats.token_name)));
-            current_stats.token_name.clear();
-            break;
-        }
+template <class CharT>
+bool BasicLexer<CharT>::_pushGluedOpener(_CurrentStats& current_stats) const {
+    if (current_stats.token_name.empty() ||
+        _findCombiningToken(current_stats, true) == _combining_tokens.end()) {
+        return false;
     }
+    return !_continuesOpener(current_stats) && _pushToken(current_stats, true);
 }
 
-void Lexer::_addIndividualChars(_CurrentStats& current_stats) {
-    if (!current_stats.token_name.empty()) {
-        _pushToken(current_stats);
+template <class CharT>
+void BasicLexer<CharT>::_pushText(
+    _CurrentStats& current_stats,
+    typename std::vector<combining_tokens_t>::const_iterator close_token) const {
+    if (current_stats.char_it == current_stats.end_it) {
+        return;
+    }
+    string_view_t close_text = close_token->end.getText();
+    string_view_t text(current_stats.char_it, current_stats.end_it);
+    size_t close_start = findDelimiter(text, close_text);
+    bool closed = close_start != string_view_t::npos;
+    size_t text_size = closed ? close_start + close_text.size() : text.size();
+    string_view_t body = text.substr(0, closed ? close_start : text.size());
+
+    // a long body is hashed in the pass that counts its lines
+    size_t lines = 0;
+    uint64_t body_id = _token_id.identifyCountingLines(body, lines);
+    // a line break that closes the text is counted by the line itself
+    size_t counted_size = text_size - (closed ? 1 : 0);
+    lines += std::count(text.begin() + body.size(), text.begin() + counted_size,
+                        CharT('\n'));
+    current_stats.region_lines += lines;
+    current_stats.c = static_cast<wchar_t>(text[text_size - 1]);
+
+    if (!closed) {
+        current_stats.token_start = current_stats.char_it;
+        current_stats.token_name = text;
+        current_stats.token_id = body_id;
+        current_stats.opener_node = 0;
+        current_stats.char_it = current_stats.end_it;
+        return;
     }
-    current_stats.token_name.push_back(current_stats.c);
-    _pushToken(current_stats);
+    current_stats.char_it += static_cast<std::ptrdiff_t>(text_size);
+    if (!body.empty()) {
+        _pushTokenText(current_stats, body, body_id);
+    }
+    _pushTokenText(current_stats, text.substr(close_start, close_text.size()));
 }
 
-void Lexer::_nextLine(_CurrentStats& current_stats) {
-    _pushToken(current_stats);
-    current_stats.token_line.line_number = current_stats.line_number++;
-    if (!current_stats.token_line.tokens.empty()) {
-        current_stats.token_lines.push_back(std::move(current_stats.token_line));
+template <class CharT>
+void BasicLexer<CharT>::_addIndividualChars(_CurrentStats& current_stats) const {
+    if (_pushToken(current_stats, true)) {
+        return;
     }
+    _appendChar(current_stats);
+    _pushToken(current_stats, false);
 }
 
-bool Lexer::_isCharFromSpecialAlhpabet(wchar_t c) const {
-    for (const std::wstring& alphabet : _special_alphabets) {
-        if (alphabet.find(c) != std::wstring::npos) {
-            return true;
-        }
+template <class CharT>
+void BasicLexer<CharT>::_nextLine(_CurrentStats& current_stats) const {
+    // a token that completes the line never opens a combined text
+    if (!current_stats.token_name.empty()) {
+        _pushTokenName(current_stats);
     }
-    return false;
+    current_stats.tokens.endLine(
+        current_stats.line_number,
+        static_cast<size_t>(current_stats.line_start - current_stats.begin_it),
+        static_cast<size_t>(current_stats.char_it - current_stats.line_start));
+    current_stats.line_number += 1 + current_stats.region_lines;
+    current_stats.region_lines = 0;
+    current_stats.line_start = current_stats.char_it;
 }
 
-bool Lexer::_isDifferentAlphabets(wchar_t a, wchar_t b) const {
+template <class CharT>
+bool BasicLexer<CharT>::_isDifferentAlphabets(wchar_t a, wchar_t b) const {
     if (a == b) {
         return false;
     }
-    auto it_a = _special_alphabets.end(), it_b = _special_alphabets.end();
-    for (auto it = _special_alphabets.begin(); it != _special_alphabets.end(); ++it) {
-        if (it->find(a) != std::wstring::npos) {
-            it_a = it;
-        }
-        if (it->find(b) != std::wstring::npos) {
-            it_b = it;
-        }
-        if (it_a != _special_alphabets.end() && it_b != _special_alphabets.end()) {
-            break;
-        }
+    auto class_a = _char_classes[a], class_b = _char_classes[b];
+    if (class_a < _ALPHABET_CHAR || class_b < _ALPHABET_CHAR) {
+        return (class_a < _ALPHABET_CHAR) != (class_b < _ALPHABET_CHAR);
     }
-    if (it_a == it_b) {
-        return false;
+    // characters are of the same alphabet if some alphabet contains both
+    return !_alphabet_groups.overlap(class_a - _ALPHABET_CHAR, class_b - _ALPHABET_CHAR);
+}
+
+template <class CharT> void BasicLexer<CharT>::_compile() {
+    // the classes of characters are kept by code points
+    std::vector<std::wstring> special_alphabets;
+    for (const string_t& special_alphabet : _special_alphabets) {
+        special_alphabets.push_back(toWide(string_view_t(special_alphabet)));
     }
-    return true;
+    std::wstring individual_chars = toWide(string_view_t(_individual_chars));
+    std::wstring separators = toWide(string_view_t(_separators));
+    std::vector<CombiningTokens> combining_tokens;
+    for (const combining_tokens_t& combining_token : _combining_tokens) {
+        combining_tokens.push_back(CombiningTokens(
+            Token(lexer::defineTokenId<uint64_t>,
+                  toWide(string_view_t(combining_token.start.getText()))),
+            Token(lexer::defineTokenId<uint64_t>,
+                  toWide(string_view_t(combining_token.end.getText())))));
+    }
+
+    std::vector<std::wstring_view> alphabet_views(special_alphabets.begin(),
+                                                  special_alphabets.end());
+    _alphabet_groups = DfaBuilder::groupAlphabets(alphabet_views);
+    _char_classes.clear(_DEFAULT_CHAR);
+    for (wchar_t c : separators) {
+        _char_classes.set(c, _SEPARATOR_CHAR);
+    }
+    for (const auto& [c, group] : _alphabet_groups.char_groups) {
+        _char_classes.set(c,
+                          static_cast<CharClassTable::class_t>(_ALPHABET_CHAR + group));
+    }
+    for (wchar_t c : individual_chars) {
+        _char_classes.set(c, _INDIVIDUAL_CHAR);
+    }
+
+    size_t threads = _dfa.getThreadsNumber();
+    _dfa = LexerDfa(special_alphabets, individual_chars, combining_tokens, separators);
+    _dfa.setThreadsNumber(threads);
 }
 
-void Lexer::_addSpecialAlphabet(_CurrentStats& current_stats) {
+template <class CharT>
+void BasicLexer<CharT>::_addSpecialAlphabet(_CurrentStats& current_stats) const {
     if (!current_stats.token_name.empty() &&
-        _isDifferentAlphabets(current_stats.token_name.back(), current_stats.c)) {
-        _pushToken(current_stats);
+        _isDifferentAlphabets(current_stats.last_c, current_stats.c)) {
+        if (_pushToken(current_stats, true)) {
+            return;
+        }
+    } else if (_pushGluedOpener(current_stats)) {
+        return;
     }
-    current_stats.token_name.push_back(current_stats.c);
+    _appendChar(current_stats);
 }
 
-Lexer::Lexer(const std::vector<std::wstring>& special_alphabets,
-             const std::wstring& individual_chars,
-             const std::vector<CombiningTokens>& combining_tokens,
-             const std::wstring& separators, Token::define_id_func_t defineTokenIdFunc) :
+template <class CharT>
+BasicLexer<CharT>::BasicLexer(const std::vector<string_t>& special_alphabets,
+                              const string_t& individual_chars,
+                              const std::vector<combining_tokens_t>& combining_tokens,
+                              const string_t& separators,
+                              define_id_func_t defineTokenIdFunc, Engine engine) :
     _special_alphabets(special_alphabets),
     _individual_chars(individual_chars),
     _combining_tokens(combining_tokens),
     _separators(separators),
-    _defineTokenId(defineTokenIdFunc) {}
+    _token_id(std::move(defineTokenIdFunc)),
+    _engine(engine),
+    _zero_copy(false),
+    _interner(nullptr) {
+    _compile();
+}
 
-Lexer::Lexer(const Lexer& other) :
+template <class CharT>
+BasicLexer<CharT>::BasicLexer(const BasicLexer& other) :
     _special_alphabets(other._special_alphabets),
     _individual_chars(other._individual_chars),
     _combining_tokens(other._combining_tokens),
-    _defineTokenId(other._defineTokenId),
-    _separators(other._separators) {}
-
-Lexer::Lexer(Lexer&& other) noexcept :
+    _token_id(other._token_id),
+    _separators(other._separators),
+    _char_classes(other._char_classes),
+    _alphabet_groups(other._alphabet_groups),
+    _dfa(other._dfa),
+    _engine(other._engine),
+    _zero_copy(other._zero_copy),
+    _interner(other._interner) {}
+
+template <class CharT>
+BasicLexer<CharT>::BasicLexer(BasicLexer&& other) noexcept :
     _special_alphabets(std::move(other._special_alphabets)),
     _individual_chars(std::move(other._individual_chars)),
     _combining_tokens(std::move(other._combining_tokens)),
-    _defineTokenId(std::move(other._defineTokenId)),
-    _separators(std::move(other._separators)) {}
-
-Lexer& Lexer::operator=(const Lexer& right) {
-    _defineTokenId = right._defineTokenId;
+    _token_id(std::move(other._token_id)),
+    _separators(std::move(other._separators)),
+    _char_classes(std::move(other._char_classes)),
+    _alphabet_groups(std::move(other._alphabet_groups)),
+    _dfa(std::move(other._dfa)),
+    _engine(other._engine),
+    _zero_copy(other._zero_copy),
+    _interner(other._interner) {}
+
+template <class CharT>
+BasicLexer<CharT>& BasicLexer<CharT>::operator=(const BasicLexer& right) {
+    _token_id = right._token_id;
     _special_alphabets = right._special_alphabets;
     _individual_chars = right._individual_chars;
     _combining_tokens = right._combining_tokens;
     _separators = right._separators;
+    _char_classes = right._char_classes;
+    _alphabet_groups = right._alphabet_groups;
+    _dfa = right._dfa;
+    _engine = right._engine;
+    _zero_copy = right._zero_copy;
+    _interner = right._interner;
     return *this;
 }
 
-Lexer& Lexer::operator=(Lexer&& right) noexcept {
-    _defineTokenId = std::move(right._defineTokenId);
+template <class CharT>
+BasicLexer<CharT>& BasicLexer<CharT>::operator=(BasicLexer&& right) noexcept {
+    _token_id = std::move(right._token_id);
     _special_alphabets = std::move(right._special_alphabets);
     _individual_chars = std::move(right._individual_chars);
     _combining_tokens = std::move(right._combining_tokens);
     _separators = std::move(right._separators);
+    _char_classes = std::move(right._char_classes);
+    _alphabet_groups = std::move(right._alphabet_groups);
+    _dfa = std::move(right._dfa);
+    _engine = right._engine;
+    _zero_copy = right._zero_copy;
+    _interner = right._interner;
     return *this;
 }
 
-void Lexer::setSpecialAlphabets(const std::vector<std::wstring>& new_special_alphabets) {
+template <class CharT>
+void BasicLexer<CharT>::setSpecialAlphabets(
+    const std::vector<string_t>& new_special_alphabets) {
     _special_alphabets = new_special_alphabets;
+    _compile();
 }
 
-void Lexer::addSpecialAlphabet(const std::wstring& new_special_alphabet) {
+template <class CharT>
+void BasicLexer<CharT>::addSpecialAlphabet(const string_t& new_special_alphabet) {
     _special_alphabets.push_back(new_special_alphabet);
+    _compile();
 }
 
-void Lexer::setSpecialAlphabets(
-    std::vector<std::wstring>&& new_special_alphabets) noexcept {
+template <class CharT>
+void BasicLexer<CharT>::setSpecialAlphabets(
+    std::vector<string_t>&& new_special_alphabets) {
     _special_alphabets = std::move(new_special_alphabets);
+    _compile();
 }
 
-void Lexer::addSpecialAlphabet(std::wstring&& new_special_alphabet) noexcept {
+template <class CharT>
+void BasicLexer<CharT>::addSpecialAlphabet(string_t&& new_special_alphabet) {
     _special_alphabets.push_back(std::move(new_special_alphabet));
+    _compile();
 }
 
-void Lexer::setIndividualChars(const std::wstring& new_individual_chars) {
+template <class CharT>
+void BasicLexer<CharT>::setIndividualChars(const string_t& new_individual_chars) {
     _individual_chars = new_individual_chars;
+    _compile();
 }
 
-void Lexer::addIndividualChar(const wchar_t& new_individual_char) {
+template <class CharT>
+void BasicLexer<CharT>::addIndividualChar(const char_t& new_individual_char) {
     _individual_chars.push_back(new_individual_char);
+    _compile();
 }
 
-void Lexer::setIndividualChars(std::wstring&& new_individual_chars) noexcept {
+template <class CharT>
+void BasicLexer<CharT>::setIndividualChars(string_t&& new_individual_chars) {
     _individual_chars = std::move(new_individual_chars);
+    _compile();
 }
 
-void Lexer::addIndividualChar(wchar_t&& new_individual_char) noexcept {
+template <class CharT>
+void BasicLexer<CharT>::addIndividualChar(char_t&& new_individual_char) {
     _individual_chars.push_back(std::move(new_individual_char));
+    _compile();
 }
 
-void Lexer::setCombiningTokens(const std::vector<CombiningTokens>& new_combining_tokens) {
+template <class CharT>
+void BasicLexer<CharT>::setCombiningTokens(
+    const std::vector<combining_tokens_t>& new_combining_tokens) {
     _combining_tokens = new_combining_tokens;
+    _compile();
 }
 
-void Lexer::addCombiningToken(const CombiningTokens& new_combining_token) {
+template <class CharT>
+void BasicLexer<CharT>::addCombiningToken(const combining_tokens_t& new_combining_token) {
     _combining_tokens.push_back(new_combining_token);
+    _compile();
 }
 
-void Lexer::setCombiningTokens(
-    std::vector<CombiningTokens>&& new_combining_tokens) noexcept {
+template <class CharT>
+void BasicLexer<CharT>::setCombiningTokens(
+    std::vector<combining_tokens_t>&& new_combining_tokens) {
     _combining_tokens = std::move(new_combining_tokens);
+    _compile();
 }
 
-void Lexer::addCombiningToken(CombiningTokens&& new_combining_token) noexcept {
+template <class CharT>
+void BasicLexer<CharT>::addCombiningToken(combining_tokens_t&& new_combining_token) {
     _combining_tokens.push_back(std::move(new_combining_token));
+    _compile();
+}
+
+template <class CharT> void BasicLexer<CharT>::setEngine(Engine new_engine) {
+    _engine = new_engine;
+}
+
+template <class CharT> LexerEngine BasicLexer<CharT>::getEngine() const {
+    return _engine;
+}
+
+template <class CharT> void BasicLexer<CharT>::setZeroCopy(bool zero_copy) {
+    _zero_copy = zero_copy;
 }
 
-std::vector<std::wstring> Lexer::getSpecialAlphabets() const {
+template <class CharT> bool BasicLexer<CharT>::isZeroCopy() const {
+    return _zero_copy;
+}
+
+template <class CharT> void BasicLexer<CharT>::setThreadsNumber(size_t threads) {
+    _dfa.setThreadsNumber(threads);
+}
+
+template <class CharT> size_t BasicLexer<CharT>::getThreadsNumber() const {
+    return _dfa.getThreadsNumber();
+}
+
+template <class CharT>
+void BasicLexer<CharT>::setInterner(std::shared_ptr<interner_t> interner) {
+    _interner = std::move(interner);
+}
+
+template <class CharT>
+std::shared_ptr<typename BasicLexer<CharT>::interner_t>
+BasicLexer<CharT>::getInterner() const {
+    return _interner;
+}
+
+template <class CharT>
+std::vector<std::basic_string<CharT>> BasicLexer<CharT>::getSpecialAlphabets() const {
     return _special_alphabets;
 }
 
-std::wstring Lexer::getIndividualChars() const {
+template <class CharT>
+std::basic_string<CharT> BasicLexer<CharT>::getIndividualChars() const {
     return _individual_chars;
 }
 
-std::vector<CombiningTokens> Lexer::getCombiningTokens() const {
-    return std::vector<CombiningTokens>();
+template <class CharT>
+std::vector<BasicCombiningTokens<CharT>> BasicLexer<CharT>::getCombiningTokens() const {
+    return std::vector<combining_tokens_t>();
 }
 
-LexerContaner Lexer::createTokens(const char* file_name) {
-    std::wifstream file(file_name);
-    auto tokens = createTokens(file);
-    file.close();
-    return tokens;
+template <class CharT>
+BasicLexerContaner<CharT>
+BasicLexer<CharT>::createTokens(const char* file_name,
+                                std::pmr::memory_resource* resource) const {
+    // the tokens are made from the mapped UTF-8 bytes without reading them first
+    MappedFile file(file_name);
+    std::string_view contents = file.getContents();
+    if constexpr (std::is_same_v<CharT, char>) {
+        return createTokens(std::u8string_view(
+                                reinterpret_cast<const char8_t*>(contents.data()),
+                                contents.size()),
+                            resource);
+    } else {
+        return createTokens(contents, resource);
+    }
 }
 
-LexerContaner Lexer::createTokens(std::wifstream& file) {
-#ifdef __linux__
-    file.imbue(std::locale(std::locale(), new std::codecvt_utf8<wchar_t>));
-#endif
+template <class CharT>
+BasicLexerContaner<CharT>
+BasicLexer<CharT>::createTokens(std::wifstream& file,
+                                std::pmr::memory_resource* resource) const
+    requires std::is_same_v<CharT, wchar_t>
+{
+    file.imbue(std::locale(std::locale(), new Utf8Codecvt));
 
-    LexerContaner tokens;
+    contaner_t tokens;
 
     if (file.is_open()) {
-        file.seekg(0, std::ios_base::end);
-
+        // the buffer of the file is converted a block at a time
         std::wstring str;
-        str.reserve(file.tellg());
-
-        file.seekg(0, std::ios_base::beg);
-
-        while (!file.eof()) {
-            str.push_back(file.get());
+        wchar_t block[1 << 14];
+        while (file.read(block, sizeof(block) / sizeof(wchar_t)) || file.gcount() > 0) {
+            str.append(block, static_cast<size_t>(file.gcount()));
         }
-        str.pop_back();
 
-        tokens = createTokens(str);
+        tokens = createTokens(std::move(str), resource);
     } else {
         throw std::runtime_error("file is not exist");
     }
@@ -264,32 +520,227 @@ LexerContaner Lexer::createTokens(std::wifstream& file) {
     return tokens;
 }
 
-LexerContaner Lexer::createTokens(const std::wstring& str) {
-    _CurrentStats current_stats { 1, {}, L"", {}, 0, str.begin(), str.end() };
+template <class CharT>
+std::vector<BasicLexerContaner<CharT>>
+BasicLexer<CharT>::createTokensBatch(std::span<const std::filesystem::path> file_names,
+                                     size_t threads) const {
+    std::vector<contaner_t> results(file_names.size());
+    if (file_names.empty()) {
+        return results;
+    }
+    if (threads == 0) {
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    threads = std::min(threads, file_names.size());
+
+    // the largest files are read first, so they are not left for the end
+    std::vector<size_t> order = sortBySize(file_names.size(), [&](size_t i) {
+        std::error_code error;
+        uintmax_t size = std::filesystem::file_size(file_names[i], error);
+        return error ? 0 : size;
+    });
+    std::vector<std::string> ordered_names;
+    ordered_names.reserve(order.size());
+    for (size_t i : order) {
+        ordered_names.push_back(file_names[i].string());
+    }
 
-    while (current_stats.char_it != current_stats.end_it) {
-        current_stats.c = *current_stats.char_it;
-        ++current_stats.char_it;
-        current_stats.token_line.original.push_back(current_stats.c);
+    FileBatchReader reader(std::move(ordered_names));
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto work = [&]() {
+        size_t index;
+        std::string contents;
+        for (;;) {
+            try {
+                if (!reader.next(index, contents)) {
+                    return;
+                }
+                // the same entry points as the ones of createTokens(const char*)
+                if constexpr (std::is_same_v<CharT, char>) {
+                    results[order[index]] = createTokens(std::u8string_view(
+                        reinterpret_cast<const char8_t*>(contents.data()),
+                        contents.size()));
+                } else {
+                    results[order[index]] = createTokens(std::string_view(contents));
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
 
-        if (_individual_chars.find(current_stats.c) != std::wstring::npos) {
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return results;
+}
+
+template <class CharT>
+std::vector<BasicLexerContaner<CharT>>
+BasicLexer<CharT>::createTokensBatch(std::span<const string_view_t> inputs,
+                                     size_t threads) const {
+    std::vector<contaner_t> results(inputs.size());
+    std::vector<size_t> order =
+        sortBySize(inputs.size(), [&](size_t i) { return inputs[i].size(); });
+    WorkStealingPool(threads).run(
+        order, [&](size_t i) { results[i] = _createTokensOfView(inputs[i], nullptr); });
+    return results;
+}
+
+template <class CharT>
+BasicLexerStream<CharT> BasicLexer<CharT>::createStream(string_view_t str) const {
+    return stream_t(_dfa, str, _token_id);
+}
+
+template <class CharT>
+BasicLexerSession<CharT>
+BasicLexer<CharT>::createSession(typename session_t::token_callback_t callback) const {
+    return session_t(_dfa, std::move(callback), _token_id);
+}
+
+template <class CharT>
+BasicLexerContaner<CharT>
+BasicLexer<CharT>::_createTokens(string_view_t str,
+                                 typename contaner_t::source_t source,
+                                 std::pmr::memory_resource* resource) const {
+    // the offsets of the tokens refer to a copy of the contents if there is no source
+    if (source == nullptr) {
+        source = std::make_shared<const string_t>(str);
+    }
+    _CurrentStats current_stats {
+        1, 0, BasicLexerContanerBuilder<CharT>(std::move(source), _interner, resource),
+        {},
+        TEXT_ID_BASIS<uint64_t>, 0, 0, 0, true,
+        str.begin(), str.begin(), str.begin(), str.begin(), str.begin(), str.end()
+    };
+
+    while (current_stats.char_it != current_stats.end_it) {
+        // a character may take several units of UTF-8 or UTF-16 text
+        size_t char_size = 1;
+        current_stats.char_begin = current_stats.char_it;
+        current_stats.c = static_cast<wchar_t>(decodeChar(
+            string_view_t(current_stats.char_it, current_stats.end_it), char_size));
+        current_stats.char_it += static_cast<std::ptrdiff_t>(char_size);
+
+        auto char_class = _char_classes[current_stats.c];
+        if (char_class == _INDIVIDUAL_CHAR) {
             _addIndividualChars(current_stats);
-        } else if (_isCharFromSpecialAlhpabet(current_stats.c)) {
+        } else if (char_class >= _ALPHABET_CHAR) {
             _addSpecialAlphabet(current_stats);
-        } else if (_separators.find(current_stats.c) != std::wstring::npos) {
-            _pushToken(current_stats);
-        } else {
-            current_stats.token_name.push_back(current_stats.c);
+        } else if (char_class == _SEPARATOR_CHAR) {
+            _pushToken(current_stats, true);
+        } else if (!_pushGluedOpener(current_stats)) {
+            _appendChar(current_stats);
         }
 
         if (current_stats.c == L'\n') {
             _nextLine(current_stats);
         }
     }
-    if (!current_stats.token_name.empty()) {
-        current_stats.token_name.pop_back();
-    }
     _nextLine(current_stats);
 
-    return LexerContaner(std::move(current_stats.token_lines));
+    return current_stats.tokens.build();
+}
+
+template <class CharT>
+BasicLexerContaner<CharT>
+BasicLexer<CharT>::_createTokenViews(string_t&& str,
+                                     std::pmr::memory_resource* resource) const {
+    auto source = std::make_shared<const string_t>(std::move(str));
+    if (_engine == Engine::Dfa) {
+        return _dfa.createTokenViews<CharT>(std::move(source), _token_id, _interner,
+                                            resource);
+    }
+    string_view_t text(*source);
+    return _createTokens(text, std::move(source), resource);
+}
+
+template <class CharT>
+BasicLexerContaner<CharT>
+BasicLexer<CharT>::createTokens(string_t&& str,
+                                std::pmr::memory_resource* resource) const {
+    return _createTokenViews(std::move(str), resource);
 }
+
+template <class CharT>
+BasicLexerContaner<CharT>
+BasicLexer<CharT>::_createTokensOfView(string_view_t str,
+                                       std::pmr::memory_resource* resource) const {
+    if (_engine == Engine::Dfa) {
+        if constexpr (std::is_same_v<CharT, char8_t>) {
+            return _dfa.createTokens<CharT>(asChars(str), _token_id, _interner, resource);
+        } else {
+            return _dfa.createTokens<CharT>(str, _token_id, _interner, resource);
+        }
+    }
+    return _createTokens(str, nullptr, resource);
+}
+
+template <class CharT>
+BasicLexerContaner<CharT>
+BasicLexer<CharT>::createTokens(const string_t& str,
+                                std::pmr::memory_resource* resource) const {
+    return _createTokensOfView(str, resource);
+}
+
+template <class CharT>
+BasicLexerContaner<CharT>
+BasicLexer<CharT>::createTokens(std::string_view str,
+                                std::pmr::memory_resource* resource) const
+    requires(!std::is_same_v<CharT, char>)
+{
+    if (_zero_copy) {
+        // the tokens refer to the contents in their own encoding
+        if constexpr (std::is_same_v<CharT, char8_t>) {
+            return _createTokenViews(string_t(str.begin(), str.end()), resource);
+        } else {
+            return _createTokenViews(fromUtf8<CharT>(str), resource);
+        }
+    }
+    if (_engine == Engine::Dfa) {
+        return _dfa.createTokens<CharT>(str, _token_id, _interner, resource);
+    }
+    if constexpr (std::is_same_v<CharT, char8_t>) {
+        return _createTokens(string_view_t(reinterpret_cast<const CharT*>(str.data()),
+                                           str.size()),
+                             nullptr, resource);
+    } else {
+        return _createTokens(fromUtf8<CharT>(str), nullptr, resource);
+    }
+}
+
+template <class CharT>
+BasicLexerContaner<CharT>
+BasicLexer<CharT>::createTokens(std::u8string_view str,
+                                std::pmr::memory_resource* resource) const
+    requires(!std::is_same_v<CharT, char8_t>)
+{
+    if constexpr (std::is_same_v<CharT, char>) {
+        if (_zero_copy) {
+            return _createTokenViews(string_t(str.begin(), str.end()), resource);
+        }
+        if (_engine == Engine::Dfa) {
+            return _dfa.createTokens<CharT>(asChars(str), _token_id, _interner, resource);
+        }
+        return _createTokens(asChars(str), nullptr, resource);
+    } else {
+        return createTokens(asChars(str), resource);
+    }
+}
+
+template class lexer::BasicLexer<char>;
+template class lexer::BasicLexer<char8_t>;
+template class lexer::BasicLexer<char16_t>;
+template class lexer::BasicLexer<wchar_t>;
@@ -0,0 +1,120 @@
+#include "../include/lexer/mapped-file.h"
+
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LEXER_HAS_MMAP 1
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+using namespace lexer;
+
+#ifdef LEXER_HAS_MMAP
+MappedFile::MappedFile(const char* file_name) : _data(nullptr), _size(0), _mapped(false) {
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("file is not exist");
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) &&
+        file_stat.st_size > 0) {
+        size_t size = static_cast<size_t>(file_stat.st_size);
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, size, MADV_SEQUENTIAL);
+            close(fd);
+            _data = static_cast<const char*>(data);
+            _size = size;
+            _mapped = true;
+            return;
+        }
+    }
+
+    // the size of a pipe or a device is not known, it is read until the end
+    char block[1 << 16];
+    for (;;) {
+        ssize_t n = read(fd, block, sizeof(block));
+        if (n < 0) {
+            close(fd);
+            throw std::runtime_error("file is not readable");
+        }
+        if (n == 0) {
+            break;
+        }
+        _buffer.append(block, static_cast<size_t>(n));
+    }
+    close(fd);
+    _data = _buffer.data();
+    _size = _buffer.size();
+}
+
+void MappedFile::_unmap() {
+    if (_mapped) {
+        munmap(const_cast<char*>(_data), _size);
+        _mapped = false;
+    }
+}
+#else
+MappedFile::MappedFile(const char* file_name) : _data(nullptr), _size(0), _mapped(false) {
+    std::ifstream file(file_name, std::ios_base::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("file is not exist");
+    }
+    _buffer.assign(std::istreambuf_iterator<char>(file),
+                   std::istreambuf_iterator<char>());
+    _data = _buffer.data();
+    _size = _buffer.size();
+}
+
+void MappedFile::_unmap() {}
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+    _data(other._data),
+    _size(other._size),
+    _mapped(other._mapped),
+    _buffer(std::move(other._buffer)) {
+    if (!_mapped) {
+        _data = _buffer.data();
+    }
+    other._data = nullptr;
+    other._size = 0;
+    other._mapped = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& right) noexcept {
+    if (this != &right) {
+        _unmap();
+        _data = right._data;
+        _size = right._size;
+        _mapped = right._mapped;
+        _buffer = std::move(right._buffer);
+        if (!_mapped) {
+            _data = _buffer.data();
+        }
+        right._data = nullptr;
+        right._size = 0;
+        right._mapped = false;
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    _unmap();
+}
+
+std::string_view MappedFile::getContents() const {
+    return std::string_view(_data, _size);
+}
+
+bool MappedFile::isMapped() const {
+    return _mapped;
+}
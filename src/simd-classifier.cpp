@@ -0,0 +1,163 @@
+#include "../include/lexer/simd-classifier.h"
+
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define LEXER_SIMD_AVX2
+    #include <immintrin.h>
+#endif
+
+using namespace lexer;
+
+namespace {
+#ifdef LEXER_SIMD_AVX2
+    // 32 characters are loaded as bytes, characters above 0xFF become 0xFF
+    template <typename CharT>
+    __attribute__((target("avx2"))) __m256i loadBytes(const CharT* chars) {
+        const __m256i* p = reinterpret_cast<const __m256i*>(chars);
+        if constexpr (sizeof(CharT) == 1) {
+            return _mm256_loadu_si256(p);
+        } else if constexpr (sizeof(CharT) == 4) {
+            const __m256i max_char = _mm256_set1_epi32(0xFF);
+            __m256i a = _mm256_min_epu32(_mm256_loadu_si256(p), max_char);
+            __m256i b = _mm256_min_epu32(_mm256_loadu_si256(p + 1), max_char);
+            __m256i c = _mm256_min_epu32(_mm256_loadu_si256(p + 2), max_char);
+            __m256i d = _mm256_min_epu32(_mm256_loadu_si256(p + 3), max_char);
+            __m256i bytes = _mm256_packus_epi16(_mm256_packus_epi32(a, b),
+                                                _mm256_packus_epi32(c, d));
+            return _mm256_permutevar8x32_epi32(bytes,
+                                               _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+        } else {
+            const __m256i max_char = _mm256_set1_epi16(0xFF);
+            __m256i a = _mm256_min_epu16(_mm256_loadu_si256(p), max_char);
+            __m256i b = _mm256_min_epu16(_mm256_loadu_si256(p + 1), max_char);
+            return _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b),
+                                            _MM_SHUFFLE(3, 1, 2, 0));
+        }
+    }
+
+    __attribute__((target("avx2"))) uint32_t matchBytes(__m256i bytes,
+                                                        __m256i low_table) {
+        const __m256i high_table = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0,
+                                                    0, 0, 0, 0, 0, 1, 2, 4, 8, 16, 32, 64,
+                                                    -128, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+        __m256i low = _mm256_shuffle_epi8(low_table, _mm256_and_si256(bytes, nibble));
+        __m256i high = _mm256_shuffle_epi8(
+            high_table, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble));
+        __m256i found = _mm256_cmpeq_epi8(_mm256_and_si256(low, high),
+                                          _mm256_setzero_si256());
+        return ~static_cast<uint32_t>(_mm256_movemask_epi8(found));
+    }
+
+    template <typename CharT>
+    __attribute__((target("avx2"))) SimdClassifier::masks_t
+    classifyAvx2(const CharT* block,
+                 const std::array<std::array<uint8_t, 16>, SimdClassifier::SETS_NUMBER>&
+                     low_nibbles) {
+        SimdClassifier::masks_t masks;
+        __m256i first = loadBytes(block);
+        __m256i second = loadBytes(block + 32);
+        for (size_t s = 0; s < SimdClassifier::SETS_NUMBER; ++s) {
+            __m256i low_table = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(low_nibbles[s].data())));
+            masks[s] = static_cast<uint64_t>(matchBytes(first, low_table)) |
+                       static_cast<uint64_t>(matchBytes(second, low_table)) << 32;
+        }
+        return masks;
+    }
+#endif
+}  // namespace
+
+SimdClassifier::SimdClassifier() : _enabled(isSupported()) {
+    for (auto& low_nibbles : _low_nibbles) {
+        low_nibbles.fill(0);
+    }
+}
+
+void SimdClassifier::addChar(size_t set, wchar_t c) {
+    if (static_cast<std::make_unsigned_t<wchar_t>>(c) < 128) {
+        _low_nibbles[set][c & 0x0F] |= static_cast<uint8_t>(1 << (c >> 4));
+    }
+}
+
+bool SimdClassifier::contains(size_t set, wchar_t c) const {
+    return static_cast<std::make_unsigned_t<wchar_t>>(c) < 128 &&
+           (_low_nibbles[set][c & 0x0F] & (1 << (c >> 4))) != 0;
+}
+
+void SimdClassifier::setEnabled(bool enabled) {
+    _enabled = enabled && isSupported();
+}
+
+bool SimdClassifier::isEnabled() const {
+    return _enabled;
+}
+
+bool SimdClassifier::isSupported() {
+#ifdef LEXER_SIMD_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+template <typename CharT>
+SimdClassifier::masks_t SimdClassifier::_classifyScalar(const CharT* block,
+                                                        size_t n) const {
+    masks_t masks;
+    masks.fill(0);
+    for (size_t i = 0; i < n; ++i) {
+        // bytes above ASCII are never in the sets
+        wchar_t c = static_cast<std::make_unsigned_t<CharT>>(block[i]);
+        for (size_t s = 0; s < SETS_NUMBER; ++s) {
+            if (contains(s, c)) {
+                masks[s] |= uint64_t(1) << i;
+            }
+        }
+    }
+    return masks;
+}
+
+template <typename CharT>
+SimdClassifier::masks_t SimdClassifier::_classifyVector(const CharT* block) const {
+#ifdef LEXER_SIMD_AVX2
+    return classifyAvx2(block, _low_nibbles);
+#else
+    return _classifyScalar(block, BLOCK_SIZE);
+#endif
+}
+
+template <typename CharT>
+SimdClassifier::masks_t SimdClassifier::_classify(const CharT* block, size_t n) const {
+    if (!_enabled) {
+        return _classifyScalar(block, n);
+    }
+    if (n == BLOCK_SIZE) {
+        return _classifyVector(block);
+    }
+
+    // the last block is copied to avoid reading past the end of the string
+    std::array<CharT, BLOCK_SIZE> padded;
+    std::copy(block, block + n, padded.begin());
+    std::fill(padded.begin() + n, padded.end(), 0);
+    masks_t masks = _classifyVector(padded.data());
+    for (auto& mask : masks) {
+        mask &= (uint64_t(1) << n) - 1;
+    }
+    return masks;
+}
+
+SimdClassifier::masks_t SimdClassifier::classify(const wchar_t* block, size_t n) const {
+    return _classify(block, n);
+}
+
+SimdClassifier::masks_t SimdClassifier::classify(const char* block, size_t n) const {
+    return _classify(block, n);
+}
+
+SimdClassifier::masks_t SimdClassifier::classify(const char16_t* block, size_t n) const {
+    return _classify(block, n);
+}
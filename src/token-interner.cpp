@@ -0,0 +1,166 @@
+#include "../include/lexer/token-interner.h"
+#include "../include/lexer/token.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+using namespace lexer;
+
+template <class CharT>
+size_t BasicTokenInterner<CharT>::_homeSlot(uint64_t hash, size_t slots_number) {
+    // the high bits of the multiplied hash, so that ids with weak low bits (e.g. from a
+    // custom function) do not fall into a few slots
+    int bits = std::countr_zero(slots_number);
+    return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+}
+
+template <class CharT>
+typename BasicTokenInterner<CharT>::string_view_t&
+BasicTokenInterner<CharT>::_textOf(symbol_t symbol) const {
+    size_t i = symbol + FIRST_SEGMENT;
+    int segment = std::bit_width(i) - std::bit_width(FIRST_SEGMENT);
+    return _texts[segment][i - (FIRST_SEGMENT << segment)];
+}
+
+template <class CharT>
+typename BasicTokenInterner<CharT>::symbol_t
+BasicTokenInterner<CharT>::_probe(const _Table& table, string_view_t text, uint64_t hash,
+                                  size_t& slot) {
+    // the slot of the text or the empty slot where it has to be put
+    size_t mask = table.size - 1;
+    for (slot = _homeSlot(hash, table.size);; slot = (slot + 1) & mask) {
+        const _Slot& entry = table.slots[slot];
+        symbol_t stored = entry.symbol.load(std::memory_order_acquire);
+        if (stored == 0 || (entry.hash == hash && entry.text == text)) {
+            return stored;
+        }
+    }
+}
+
+template <class CharT>
+typename BasicTokenInterner<CharT>::string_view_t
+BasicTokenInterner<CharT>::_store(string_view_t text) {
+    if (text.size() > BLOCK_SIZE / 4) {
+        // a long text does not waste the rest of a block
+        _long_texts.push_back(std::make_unique<CharT[]>(text.size()));
+        std::copy(text.begin(), text.end(), _long_texts.back().get());
+        return string_view_t(_long_texts.back().get(), text.size());
+    }
+    if (_blocks.empty() || _block_used + text.size() > BLOCK_SIZE) {
+        _blocks.push_back(std::make_unique<CharT[]>(BLOCK_SIZE));
+        _block_used = 0;
+    }
+    CharT* place = _blocks.back().get() + _block_used;
+    std::copy(text.begin(), text.end(), place);
+    _block_used += text.size();
+    return string_view_t(place, text.size());
+}
+
+template <class CharT> void BasicTokenInterner<CharT>::_grow() {
+    const _Table& old = *_tables.back();
+    auto table = std::make_unique<_Table>();
+    table->size = old.size * 2;
+    table->slots = std::make_unique<_Slot[]>(table->size);
+    size_t mask = table->size - 1;
+    for (size_t i = 0; i < old.size; ++i) {
+        const _Slot& from = old.slots[i];
+        symbol_t symbol = from.symbol.load(std::memory_order_relaxed);
+        if (symbol == 0) {
+            continue;
+        }
+        size_t slot = _homeSlot(from.hash, table->size);
+        while (table->slots[slot].symbol.load(std::memory_order_relaxed) != 0) {
+            slot = (slot + 1) & mask;
+        }
+        table->slots[slot].hash = from.hash;
+        table->slots[slot].text = from.text;
+        table->slots[slot].symbol.store(symbol, std::memory_order_relaxed);
+    }
+    // the filled table is published at once
+    _table.store(table.get(), std::memory_order_release);
+    _tables.push_back(std::move(table));
+}
+
+template <class CharT>
+BasicTokenInterner<CharT>::BasicTokenInterner() : _block_used(0), _size(0) {
+    auto table = std::make_unique<_Table>();
+    table->size = 64;
+    table->slots = std::make_unique<_Slot[]>(table->size);
+    _table.store(table.get(), std::memory_order_release);
+    _tables.push_back(std::move(table));
+}
+
+template <class CharT>
+typename BasicTokenInterner<CharT>::symbol_t
+BasicTokenInterner<CharT>::intern(string_view_t text, uint64_t hash) {
+    symbol_t symbol = find(text, hash);
+    if (symbol != NO_SYMBOL) {
+        return symbol;
+    }
+
+    // another thread may have stored the text since it was looked up
+    std::lock_guard<std::mutex> lock(_mutex);
+    _Table& table = *_tables.back();
+    size_t slot;
+    symbol_t stored = _probe(table, text, hash, slot);
+    if (stored != 0) {
+        return stored - 1;
+    }
+
+    size_t size = _size.load(std::memory_order_relaxed);
+    symbol = static_cast<symbol_t>(size);
+    size_t segment = std::bit_width(size + FIRST_SEGMENT) - std::bit_width(FIRST_SEGMENT);
+    if (!_texts[segment]) {
+        _texts[segment] = std::make_unique<string_view_t[]>(FIRST_SEGMENT << segment);
+    }
+    string_view_t& stored_text = _textOf(symbol);
+    stored_text = _store(text);
+    _size.store(size + 1, std::memory_order_release);
+    table.slots[slot].hash = hash;
+    table.slots[slot].text = stored_text;
+    table.slots[slot].symbol.store(symbol + 1, std::memory_order_release);
+    // the table is kept at most half full
+    if ((size + 1) * 2 > table.size) {
+        _grow();
+    }
+    return symbol;
+}
+
+template <class CharT>
+typename BasicTokenInterner<CharT>::symbol_t
+BasicTokenInterner<CharT>::intern(string_view_t text) {
+    return intern(text, defineTextId<uint64_t, CharT>(text));
+}
+
+template <class CharT>
+typename BasicTokenInterner<CharT>::symbol_t
+BasicTokenInterner<CharT>::find(string_view_t text, uint64_t hash) const {
+    size_t slot;
+    symbol_t stored = _probe(*_table.load(std::memory_order_acquire), text, hash, slot);
+    return stored == 0 ? NO_SYMBOL : stored - 1;
+}
+
+template <class CharT>
+typename BasicTokenInterner<CharT>::symbol_t
+BasicTokenInterner<CharT>::find(string_view_t text) const {
+    return find(text, defineTextId<uint64_t, CharT>(text));
+}
+
+template <class CharT>
+typename BasicTokenInterner<CharT>::string_view_t
+BasicTokenInterner<CharT>::getText(symbol_t symbol) const {
+    if (symbol >= _size.load(std::memory_order_acquire)) {
+        throw std::out_of_range("symbol is not interned");
+    }
+    return _textOf(symbol);
+}
+
+template <class CharT> size_t BasicTokenInterner<CharT>::getSize() const {
+    return _size.load(std::memory_order_acquire);
+}
+
+template class lexer::BasicTokenInterner<char>;
+template class lexer::BasicTokenInterner<char8_t>;
+template class lexer::BasicTokenInterner<char16_t>;
+template class lexer::BasicTokenInterner<wchar_t>;
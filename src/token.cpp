@@ -2,143 +2,201 @@
 
 using namespace lexer;
 
-void Token::_updateId() {
-    _id = _defineId(_text.c_str());
-}
+template <class CharT>
+BasicTokenIdentifier<CharT>::BasicTokenIdentifier() :
+    _defineId(defineTokenId<uint64_t, CharT>),
+    _is_default(true) {}
 
-Token::Token() : _id(0), _defineId(defineTokenId<uint64_t>) {}
+template <class CharT>
+BasicTokenIdentifier<CharT>::BasicTokenIdentifier(define_id_func_t defineId) :
+    _defineId(std::move(defineId)),
+    _is_default(false) {
+    auto* function = _defineId.template target<uint64_t (*)(const CharT*)>();
+    _is_default = function != nullptr && *function == defineTokenId<uint64_t, CharT>;
+}
 
-Token::Token(const std::wstring& text) : _text(text), _defineId(defineTokenId<uint64_t>) {
-    _updateId();
+template <class CharT>
+const typename BasicTokenIdentifier<CharT>::define_id_func_t&
+BasicTokenIdentifier<CharT>::getFunction() const {
+    return _defineId;
 }
 
-Token::Token(define_id_func_t defineId) : _id(0), _defineId(defineId) {}
+template <class CharT> BasicToken<CharT>::BasicToken() : _id(0) {}
 
-Token::Token(define_id_func_t defineId, const std::wstring& text) :
-    _id(0),
-    _defineId(defineId),
-    _text(text) {
-    _updateId();
-}
+template <class CharT>
+BasicToken<CharT>::BasicToken(const string_t& text) :
+    _id(defineTokenId<uint64_t, CharT>(text.c_str())),
+    _text(text) {}
+
+template <class CharT>
+BasicToken<CharT>::BasicToken(const define_id_func_t& defineId, const string_t& text) :
+    _id(defineId(text.c_str())),
+    _text(text) {}
 
-Token::Token(const Token& other) :
+template <class CharT>
+BasicToken<CharT>::BasicToken(const BasicToken& other) :
     _id(other._id),
     _text(other._text),
-    _defineId(other._defineId) {}
+    _view(other._view) {}
 
-Token::Token(Token&& other) noexcept :
-    _id(std::move(other._id)),
+template <class CharT>
+BasicToken<CharT>::BasicToken(BasicToken&& other) noexcept :
+    _id(other._id),
     _text(std::move(other._text)),
-    _defineId(std::move(other._defineId)) {}
-
-void Token::setText(const std::wstring& new_text) {
-    _text = new_text;
-    _updateId();
-}
+    _view(other._view) {}
 
-void Token::setText(std::wstring&& new_text) noexcept {
-    _text = std::move(new_text);
-    _updateId();
+template <class CharT>
+BasicToken<CharT> BasicToken<CharT>::make(uint64_t id, string_t&& text) noexcept {
+    BasicToken token;
+    token._id = id;
+    token._text = std::move(text);
+    return token;
 }
 
-uint64_t Token::getId() const {
-    return _id;
+template <class CharT>
+BasicToken<CharT> BasicToken<CharT>::makeView(uint64_t id, string_view_t text) noexcept {
+    // an empty view still has to be marked as a view
+    static constexpr CharT EMPTY = CharT(0);
+    BasicToken token;
+    token._id = id;
+    token._view = text.data() != nullptr ? text : string_view_t(&EMPTY, 0);
+    return token;
 }
 
-std::wstring Token::getText() const {
-    return _text;
-}
-
-Token& Token::operator=(const Token& right) {
-    _text = right._text;
-    _defineId = right._defineId;
-    _updateId();
-    return *this;
+template <class CharT> void BasicToken<CharT>::setText(const string_t& new_text) {
+    _text = new_text;
+    _view = string_view_t();
+    _id = defineTokenId<uint64_t, CharT>(_text.c_str());
 }
 
-Token& Token::operator=(Token&& right) noexcept {
-    _text = std::move(right._text);
-    _defineId = std::move(right._defineId);
-    _updateId();
-    return *this;
+template <class CharT> void BasicToken<CharT>::setText(string_t&& new_text) noexcept {
+    _text = std::move(new_text);
+    _view = string_view_t();
+    _id = defineTokenId<uint64_t, CharT>(_text.c_str());
 }
 
-bool lexer::operator==(const Token& left, const Token& right) {
-    return left._id == right._id;
+template <class CharT>
+void BasicToken<CharT>::setText(const string_t& new_text,
+                                const define_id_func_t& defineId) {
+    _text = new_text;
+    _view = string_view_t();
+    _id = defineId(_text.c_str());
 }
 
-bool lexer::operator!=(const Token& left, const Token& right) {
-    return left._id != right._id;
+template <class CharT> uint64_t BasicToken<CharT>::getId() const {
+    return _id;
 }
 
-bool lexer::operator==(const TokenLine& left, const TokenLine& right) {
-    return left.line_number == right.line_number && left.tokens == right.tokens;
+template <class CharT>
+typename BasicToken<CharT>::string_view_t BasicToken<CharT>::getText() const {
+    return _view.data() != nullptr ? _view : string_view_t(_text);
 }
 
-bool lexer::operator!=(const TokenLine& left, const TokenLine& right) {
-    return !(left == right);
+template <class CharT> bool BasicToken<CharT>::isView() const {
+    return _view.data() != nullptr;
 }
 
-bool lexer::operator==(const CombiningTokens& left, const CombiningTokens& right) {
-    return left.start == right.start && left.end == right.end;
+template <class CharT>
+BasicToken<CharT>& BasicToken<CharT>::operator=(const BasicToken& right) {
+    _id = right._id;
+    _text = right._text;
+    _view = right._view;
+    return *this;
 }
 
-bool lexer::operator!=(const CombiningTokens& left, const CombiningTokens& right) {
-    return !(left == right);
+template <class CharT>
+BasicToken<CharT>& BasicToken<CharT>::operator=(BasicToken&& right) noexcept {
+    _id = right._id;
+    _text = std::move(right._text);
+    _view = right._view;
+    return *this;
 }
 
-TokenLine::TokenLine() : line_number(0) {}
+template <class CharT> BasicTokenLine<CharT>::BasicTokenLine() : line_number(0) {}
 
-TokenLine::TokenLine(size_t line_number, const std::wstring& original,
-                     const token_contaner_t& tokens) :
+template <class CharT>
+BasicTokenLine<CharT>::BasicTokenLine(size_t line_number, const string_t& original,
+                                      const token_contaner_t& tokens) :
     line_number(line_number),
     original(original),
     tokens(tokens) {}
 
-TokenLine::TokenLine(const TokenLine& other) :
+template <class CharT>
+BasicTokenLine<CharT>::BasicTokenLine(const BasicTokenLine& other) :
     line_number(other.line_number),
     original(other.original),
     tokens(other.tokens) {}
 
-TokenLine::TokenLine(TokenLine&& other) noexcept :
+template <class CharT>
+BasicTokenLine<CharT>::BasicTokenLine(BasicTokenLine&& other) noexcept :
     line_number(std::move(other.line_number)),
     original(std::move(other.original)),
     tokens(std::move(other.tokens)) {}
 
-TokenLine& TokenLine::operator=(const TokenLine& right) {
+template <class CharT>
+BasicTokenLine<CharT>& BasicTokenLine<CharT>::operator=(const BasicTokenLine& right) {
     line_number = right.line_number;
     original = right.original;
     tokens = right.tokens;
     return *this;
 }
 
-TokenLine& TokenLine::operator=(TokenLine&& right) noexcept {
+template <class CharT>
+BasicTokenLine<CharT>& BasicTokenLine<CharT>::operator=(BasicTokenLine&& right) noexcept {
     line_number = std::move(right.line_number);
     original = std::move(right.original);
     tokens = std::move(right.tokens);
     return *this;
 }
 
-CombiningTokens::CombiningTokens(const Token& start, const Token& end) :
+template <class CharT>
+BasicCombiningTokens<CharT>::BasicCombiningTokens(const BasicToken<CharT>& start,
+                                                  const BasicToken<CharT>& end) :
     start(start),
     end(end) {}
 
-CombiningTokens::CombiningTokens(const CombiningTokens& other) :
+template <class CharT>
+BasicCombiningTokens<CharT>::BasicCombiningTokens(const BasicCombiningTokens& other) :
     start(other.start),
     end(other.end) {}
 
-CombiningTokens::CombiningTokens(CombiningTokens&& other) noexcept :
-    start(std::move(other.end)),
+template <class CharT>
+BasicCombiningTokens<CharT>::BasicCombiningTokens(BasicCombiningTokens&& other) noexcept :
+    start(std::move(other.start)),
     end(std::move(other.end)) {}
 
-CombiningTokens& CombiningTokens::operator=(const CombiningTokens& right) {
+template <class CharT>
+BasicCombiningTokens<CharT>&
+BasicCombiningTokens<CharT>::operator=(const BasicCombiningTokens& right) {
     start = right.start;
     end = right.end;
     return *this;
 }
 
-CombiningTokens& CombiningTokens::operator=(CombiningTokens&& right) noexcept {
+template <class CharT>
+BasicCombiningTokens<CharT>&
+BasicCombiningTokens<CharT>::operator=(BasicCombiningTokens&& right) noexcept {
     start = std::move(right.start);
     end = std::move(right.end);
     return *this;
 }
+
+template class lexer::BasicTokenIdentifier<char>;
+template class lexer::BasicTokenIdentifier<char8_t>;
+template class lexer::BasicTokenIdentifier<char16_t>;
+template class lexer::BasicTokenIdentifier<wchar_t>;
+
+template class lexer::BasicToken<char>;
+template class lexer::BasicToken<char8_t>;
+template class lexer::BasicToken<char16_t>;
+template class lexer::BasicToken<wchar_t>;
+
+template struct lexer::BasicTokenLine<char>;
+template struct lexer::BasicTokenLine<char8_t>;
+template struct lexer::BasicTokenLine<char16_t>;
+template struct lexer::BasicTokenLine<wchar_t>;
+
+template struct lexer::BasicCombiningTokens<char>;
+template struct lexer::BasicCombiningTokens<char8_t>;
+template struct lexer::BasicCombiningTokens<char16_t>;
+template struct lexer::BasicCombiningTokens<wchar_t>;
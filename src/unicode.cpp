@@ -0,0 +1,389 @@
+#include "../include/lexer/unicode.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define LEXER_SIMD_AVX2
+    #include <immintrin.h>
+#endif
+
+namespace {
+    constexpr char32_t REPLACEMENT_CHAR = 0xFFFD;
+
+    void appendWide(std::wstring& text, char32_t c) {
+        if constexpr (sizeof(wchar_t) == 2) {
+            if (c >= 0x10000) {
+                c -= 0x10000;
+                text.push_back(static_cast<wchar_t>(0xD800 + (c >> 10)));
+                text.push_back(static_cast<wchar_t>(0xDC00 + (c & 0x3FF)));
+                return;
+            }
+        }
+        text.push_back(static_cast<wchar_t>(c));
+    }
+
+    // writes the code point as one unit or as a surrogate pair and returns the number
+    // of units
+    template <typename OutT> size_t putChar(OutT* out, char32_t c) {
+        if constexpr (sizeof(OutT) == 2) {
+            if (c >= 0x10000) {
+                c -= 0x10000;
+                out[0] = static_cast<OutT>(0xD800 + (c >> 10));
+                out[1] = static_cast<OutT>(0xDC00 + (c & 0x3FF));
+                return 2;
+            }
+        }
+        out[0] = static_cast<OutT>(c);
+        return 1;
+    }
+
+    bool hasAvx2() {
+#ifdef LEXER_SIMD_AVX2
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+#ifdef LEXER_SIMD_AVX2
+    // widens 32 bytes to 32 units and returns the number of leading ASCII bytes
+    template <typename OutT>
+    __attribute__((target("avx2"))) size_t widenAsciiAvx2(const char* in, OutT* out) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+        uint32_t non_ascii = static_cast<uint32_t>(_mm256_movemask_epi8(bytes));
+        if constexpr (sizeof(OutT) == 4) {
+            for (size_t k = 0; k < 4; ++k) {
+                __m128i part =
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + 8 * k));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 8 * k),
+                                    _mm256_cvtepu8_epi32(part));
+            }
+        } else {
+            for (size_t k = 0; k < 2; ++k) {
+                __m128i part =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * k));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 16 * k),
+                                    _mm256_cvtepu8_epi16(part));
+            }
+        }
+        return non_ascii == 0 ? 32 : static_cast<size_t>(std::countr_zero(non_ascii));
+    }
+
+    __attribute__((target("avx2"))) size_t countAsciiAvx2(const char* in) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+        uint32_t non_ascii = static_cast<uint32_t>(_mm256_movemask_epi8(bytes));
+        return non_ascii == 0 ? 32 : static_cast<size_t>(std::countr_zero(non_ascii));
+    }
+#endif
+
+    // the bytes of a word that are not ASCII
+    constexpr uint64_t NON_ASCII_BITS = 0x8080808080808080;
+
+    // widens the leading ASCII bytes of the text, out has room for text.size() units,
+    // returns the number of the widened bytes
+    template <typename OutT> size_t widenAscii(std::string_view text, OutT* out) {
+        size_t i = 0;
+#ifdef LEXER_SIMD_AVX2
+        if (hasAvx2()) {
+            while (i + 32 <= text.size()) {
+                size_t n = widenAsciiAvx2(text.data() + i, out + i);
+                i += n;
+                if (n < 32) {
+                    return i;
+                }
+            }
+        }
+#endif
+        // without vector operations 8 bytes are checked at a time
+        while (i + 8 <= text.size()) {
+            uint64_t word;
+            std::memcpy(&word, text.data() + i, 8);
+            if (word & NON_ASCII_BITS) {
+                break;
+            }
+            for (size_t k = 0; k < 8; ++k) {
+                out[i + k] = static_cast<OutT>(text[i + k]);
+            }
+            i += 8;
+        }
+        while (i < text.size() && static_cast<unsigned char>(text[i]) < 0x80) {
+            out[i] = static_cast<OutT>(text[i]);
+            ++i;
+        }
+        return i;
+    }
+
+    // returns the number of the leading ASCII bytes of the text
+    size_t countAscii(std::string_view text) {
+        size_t i = 0;
+#ifdef LEXER_SIMD_AVX2
+        if (hasAvx2()) {
+            while (i + 32 <= text.size()) {
+                size_t n = countAsciiAvx2(text.data() + i);
+                i += n;
+                if (n < 32) {
+                    return i;
+                }
+            }
+        }
+#endif
+        while (i + 8 <= text.size()) {
+            uint64_t word;
+            std::memcpy(&word, text.data() + i, 8);
+            if (word & NON_ASCII_BITS) {
+                break;
+            }
+            i += 8;
+        }
+        while (i < text.size() && static_cast<unsigned char>(text[i]) < 0x80) {
+            ++i;
+        }
+        return i;
+    }
+
+    // decodes the text into out that has room for text.size() units and returns the
+    // number of units, invalid receives the offset of the first invalid sequence
+    template <typename OutT>
+    size_t transcodeUtf8(std::string_view text, OutT* out, size_t& invalid) {
+        invalid = std::string_view::npos;
+        size_t i = 0, o = 0;
+        while (i < text.size()) {
+            size_t ascii = widenAscii(text.substr(i), out + o);
+            i += ascii;
+            o += ascii;
+            // the sequences up to the next ASCII byte are decoded one by one
+            while (i < text.size() && static_cast<unsigned char>(text[i]) >= 0x80) {
+                size_t size;
+                char32_t c = lexer::decodeUtf8(text.substr(i), size);
+                if (size == 1 && invalid == std::string_view::npos) {
+                    invalid = i;
+                }
+                o += putChar(out + o, c);
+                i += size;
+            }
+        }
+        return o;
+    }
+
+    template <typename OutT>
+    std::basic_string<OutT> convertUtf8(std::string_view text, bool strict) {
+        std::basic_string<OutT> converted;
+        size_t invalid;
+        converted.resize_and_overwrite(text.size(), [&](OutT* out, size_t) {
+            return transcodeUtf8(text, out, invalid);
+        });
+        if (strict && invalid != std::string_view::npos) {
+            throw lexer::Utf8Error(invalid);
+        }
+        return converted;
+    }
+}  // namespace
+
+lexer::Utf8Error::Utf8Error(size_t offset) :
+    std::runtime_error("invalid UTF-8 sequence at byte " + std::to_string(offset)),
+    _offset(offset) {}
+
+size_t lexer::Utf8Error::getOffset() const {
+    return _offset;
+}
+
+char32_t lexer::decodeUtf8(std::string_view text, size_t& size) {
+    const unsigned char first = static_cast<unsigned char>(text[0]);
+    size = 1;
+    if (first < 0x80) {
+        return first;
+    }
+
+    size_t length;
+    char32_t c, min_c;
+    if ((first & 0xE0) == 0xC0) {
+        length = 2, c = first & 0x1F, min_c = 0x80;
+    } else if ((first & 0xF0) == 0xE0) {
+        length = 3, c = first & 0x0F, min_c = 0x800;
+    } else if ((first & 0xF8) == 0xF0) {
+        length = 4, c = first & 0x07, min_c = 0x10000;
+    } else {
+        return REPLACEMENT_CHAR;
+    }
+    if (text.size() < length) {
+        return REPLACEMENT_CHAR;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        const unsigned char next = static_cast<unsigned char>(text[i]);
+        if ((next & 0xC0) != 0x80) {
+            return REPLACEMENT_CHAR;
+        }
+        c = c << 6 | (next & 0x3F);
+    }
+    if (c < min_c || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+        return REPLACEMENT_CHAR;
+    }
+    size = length;
+    return c;
+}
+
+char32_t lexer::decodeUtf16(std::u16string_view text, size_t& size) {
+    const char32_t first = text[0];
+    size = 1;
+    if (first >= 0xD800 && first < 0xDC00 && text.size() > 1 && text[1] >= 0xDC00 &&
+        text[1] < 0xE000) {
+        size = 2;
+        return 0x10000 + ((first - 0xD800) << 10) + (text[1] - 0xDC00);
+    }
+    return first;
+}
+
+std::wstring lexer::utf8ToWide(std::string_view text) {
+    return convertUtf8<wchar_t>(text, false);
+}
+
+std::wstring lexer::utf8ToWideStrict(std::string_view text) {
+    return convertUtf8<wchar_t>(text, true);
+}
+
+std::u16string lexer::utf8ToUtf16(std::string_view text) {
+    return convertUtf8<char16_t>(text, false);
+}
+
+size_t lexer::findInvalidUtf8(std::string_view text) {
+    for (size_t i = 0; i < text.size();) {
+        i += countAscii(text.substr(i));
+        while (i < text.size() && static_cast<unsigned char>(text[i]) >= 0x80) {
+            size_t size;
+            decodeUtf8(text.substr(i), size);
+            if (size == 1) {
+                return i;
+            }
+            i += size;
+        }
+    }
+    return std::string_view::npos;
+}
+
+std::wstring lexer::utf16ToWide(std::u16string_view text) {
+    std::wstring wide;
+    wide.reserve(text.size());
+    for (size_t i = 0; i < text.size();) {
+        size_t size;
+        appendWide(wide, decodeUtf16(text.substr(i), size));
+        i += size;
+    }
+    return wide;
+}
+
+lexer::Utf8Codecvt::Utf8Codecvt(size_t refs) :
+    std::codecvt<wchar_t, char, std::mbstate_t>(refs) {}
+
+std::codecvt_base::result
+lexer::Utf8Codecvt::do_in(state_type&, const char* from, const char* from_end,
+                          const char*& from_next, wchar_t* to, wchar_t* to_end,
+                          wchar_t*& to_next) const {
+    from_next = from;
+    to_next = to;
+    while (from_next < from_end && to_next < to_end) {
+        size_t room = static_cast<size_t>(to_end - to_next);
+        std::string_view text(from_next,
+                              std::min(static_cast<size_t>(from_end - from_next), room));
+        size_t ascii = widenAscii(text, to_next);
+        from_next += ascii;
+        to_next += ascii;
+        if (ascii == text.size()) {
+            continue;
+        }
+
+        // a sequence cut by the end of the buffer is decoded by the next call
+        std::string_view rest(from_next, static_cast<size_t>(from_end - from_next));
+        size_t length = utf8CharSize(rest[0]);
+        if (rest.size() < length) {
+            bool cut = true;
+            for (size_t k = 1; k < rest.size(); ++k) {
+                cut = cut && (static_cast<unsigned char>(rest[k]) & 0xC0) == 0x80;
+            }
+            if (cut && length > 1) {
+                return partial;
+            }
+        }
+        if (sizeof(wchar_t) == 2 && length == 4 && room < 2) {
+            return partial;
+        }
+        size_t size;
+        char32_t c = decodeUtf8(rest, size);
+        to_next += putChar(to_next, c);
+        from_next += size;
+    }
+    return from_next == from_end ? ok : partial;
+}
+
+std::codecvt_base::result
+lexer::Utf8Codecvt::do_out(state_type&, const wchar_t* from, const wchar_t* from_end,
+                           const wchar_t*& from_next, char* to, char* to_end,
+                           char*& to_next) const {
+    from_next = from;
+    to_next = to;
+    while (from_next < from_end) {
+        size_t units = 1;
+        if constexpr (sizeof(wchar_t) == 2) {
+            // a surrogate pair is encoded together
+            if (*from_next >= 0xD800 && *from_next < 0xDC00) {
+                if (from_end - from_next < 2) {
+                    return partial;
+                }
+                units = 2;
+            }
+        }
+        std::string utf8 = wideToUtf8(std::wstring_view(from_next, units));
+        if (static_cast<size_t>(to_end - to_next) < utf8.size()) {
+            return partial;
+        }
+        std::memcpy(to_next, utf8.data(), utf8.size());
+        to_next += utf8.size();
+        from_next += units;
+    }
+    return ok;
+}
+
+std::codecvt_base::result lexer::Utf8Codecvt::do_unshift(state_type&, char* to, char*,
+                                                         char*& to_next) const {
+    to_next = to;
+    return noconv;
+}
+
+int lexer::Utf8Codecvt::do_encoding() const noexcept {
+    return 0;
+}
+
+bool lexer::Utf8Codecvt::do_always_noconv() const noexcept {
+    return false;
+}
+
+int lexer::Utf8Codecvt::do_length(state_type&, const char* from, const char* from_end,
+                                  size_t max) const {
+    // the number of bytes of at most max whole characters
+    const char* it = from;
+    for (size_t n = 0; n < max && it < from_end; ++n) {
+        size_t length = utf8CharSize(*it);
+        if (static_cast<size_t>(from_end - it) < length) {
+            break;
+        }
+        size_t size;
+        decodeUtf8(std::string_view(it, static_cast<size_t>(from_end - it)), size);
+        if (sizeof(wchar_t) == 2 && size == 4) {
+            if (n + 2 > max) {
+                break;
+            }
+            ++n;
+        }
+        it += size;
+    }
+    return static_cast<int>(it - from);
+}
+
+int lexer::Utf8Codecvt::do_max_length() const noexcept {
+    return 4;
+}
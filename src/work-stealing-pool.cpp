@@ -0,0 +1,77 @@
+#include "../include/lexer/work-stealing-pool.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace lexer;
+
+bool WorkStealingPool::_take(_Queue& queue, size_t& task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+WorkStealingPool::WorkStealingPool(size_t threads) :
+    _threads_number(threads != 0
+                        ? threads
+                        : std::max<size_t>(std::thread::hardware_concurrency(), 1)) {}
+
+void WorkStealingPool::run(std::span<const size_t> tasks,
+                           const std::function<void(size_t)>& task) const {
+    size_t threads_number = std::min(_threads_number, tasks.size());
+    if (threads_number == 0) {
+        return;
+    }
+
+    // the tasks are dealt one at a time, so every queue starts with a large task
+    auto queues = std::make_unique<_Queue[]>(threads_number);
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        queues[i % threads_number].tasks.push_back(tasks[i]);
+    }
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto work = [&](size_t worker) {
+        // no tasks are added, so the work is done when every queue is empty
+        for (size_t victim = 0; victim < threads_number;) {
+            size_t taken;
+            if (!_take(queues[(worker + victim) % threads_number], taken)) {
+                ++victim;
+                continue;
+            }
+            try {
+                task(taken);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            // the own queue is checked first again
+            victim = 0;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threads_number; ++i) {
+        threads.emplace_back(work, i);
+    }
+    work(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+size_t WorkStealingPool::getThreadsNumber() const {
+    return _threads_number;
+}
@@ -0,0 +1,143 @@
+#include "../include/lexer/lexer.h"
+#include "../include/lexer/unicode.h"
+#include "lexer-test-helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <random>
+
+template <class CharT>
+static lexer::BasicLexer<CharT> makeLexer(const std::vector<std::wstring>& alphabets,
+                                          const std::wstring& individual_chars,
+                                          const std::wstring& separators,
+                                          lexer::LexerEngine engine) {
+    std::vector<std::basic_string<CharT>> special_alphabets;
+    for (const auto& alphabet : alphabets) {
+        special_alphabets.push_back(lexer::fromWide<CharT>(alphabet));
+    }
+    std::vector<lexer::BasicCombiningTokens<CharT>> combining_tokens;
+    for (auto [start, end] : { std::pair { L"\"", L"\"" }, std::pair { L"//", L"\n" },
+                               std::pair { L"/*", L"*/" }, std::pair { L"й/", L"й" } }) {
+        combining_tokens.push_back(lexer::BasicCombiningTokens<CharT> {
+            lexer::BasicToken<CharT>(lexer::fromWide<CharT>(start)),
+            lexer::BasicToken<CharT>(lexer::fromWide<CharT>(end)) });
+    }
+    return lexer::BasicLexer<CharT>(special_alphabets,
+                                    lexer::fromWide<CharT>(individual_chars),
+                                    combining_tokens, lexer::fromWide<CharT>(separators),
+                                    lexer::defineTokenId<uint64_t, CharT>, engine);
+}
+
+template <class CharT> static void expectSameAsWide(const std::wstring& separators) {
+    const std::vector<std::wstring> alphabets = { L"+-/*=<>!", L"йb" };
+    const std::wstring individual_chars = L"&?;(){}\n";
+    lexer::Lexer wide = makeLexer<wchar_t>(alphabets, individual_chars, separators,
+                                           lexer::LexerEngine::Classic);
+
+    std::mt19937 random(7);
+    for (size_t n = 0; n < 100; ++n) {
+        std::wstring code = randomCode(random, 200, RANDOM_CODE_CHARS + L"\U0001F600");
+        auto expected = wide.createTokens(code);
+        for (auto engine : { lexer::LexerEngine::Classic, lexer::LexerEngine::Dfa }) {
+            auto lexer =
+                makeLexer<CharT>(alphabets, individual_chars, separators, engine);
+            lexer.setZeroCopy(n % 2 == 1);
+            expectSameTokens<CharT>(expected,
+                                    lexer.createTokens(lexer::fromWide<CharT>(code)),
+                                    code);
+            expectSameTokens<CharT>(expected,
+                                    lexer.createTokens(lexer::wideToUtf8(code)), code);
+        }
+    }
+}
+
+TEST(LexerCharTypesTest, Test_CharTypes_Char) {
+    expectSameAsWide<char>(L" \t");
+}
+
+TEST(LexerCharTypesTest, Test_CharTypes_Char8) {
+    expectSameAsWide<char8_t>(L" \t");
+}
+
+TEST(LexerCharTypesTest, Test_CharTypes_Char16) {
+    expectSameAsWide<char16_t>(L" \t");
+}
+
+TEST(LexerCharTypesTest, Test_CharTypes_SurrogatePairs) {
+    // a character out of the BMP is a separator, so UTF-16 text is decoded by pairs
+    expectSameAsWide<char16_t>(L" \t\U0001F600");
+}
+
+TEST(LexerCharTypesTest, Test_CharTypes_Utf8Tokens) {
+    lexer::BasicLexer<char8_t> lexer({ u8"+-/*=<>!" }, u8";\n", {}, u8" ");
+    auto tokens = lexer.createTokens(std::u8string(u8"имя += 1;\n"));
+
+    ASSERT_EQ(tokens.getSize(), 5);
+    ASSERT_TRUE(tokens.getLine(0).tokens.at(0).getText() == u8"имя");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(0).getId(),
+              lexer::defineTokenId<uint64_t>(u8"имя"));
+    ASSERT_TRUE(tokens.getLine(0).original == u8"имя += 1;\n");
+}
+
+TEST(LexerCharTypesTest, Test_CharTypes_Utf8Transcoder) {
+    static const std::vector<std::string> pieces = {
+        "a", "bc d\n", "й", "€", "𝔸", "\xFF", "\xE2\x82", "\xC0\x80", std::string(40, 'x')
+    };
+    std::mt19937 random(5);
+    std::uniform_int_distribution<size_t> piece(0, pieces.size() - 1);
+    for (size_t i = 0; i < 2000; ++i) {
+        std::string text;
+        while (text.size() < i % 200) {
+            text += pieces[piece(random)];
+        }
+
+        // the code points are the ones decoded one by one
+        std::wstring expected;
+        size_t invalid = std::string::npos;
+        for (size_t k = 0; k < text.size();) {
+            size_t size;
+            char32_t c = lexer::decodeUtf8(std::string_view(text).substr(k), size);
+            if (size == 1 && static_cast<unsigned char>(text[k]) >= 0x80 &&
+                invalid == std::string::npos) {
+                invalid = k;
+            }
+            expected += lexer::utf16ToWide(lexer::wideToUtf16(std::wstring(1, c)));
+            k += size;
+        }
+        ASSERT_EQ(lexer::utf8ToWide(text), expected);
+        ASSERT_TRUE(lexer::utf8ToUtf16(text) == lexer::wideToUtf16(expected));
+        ASSERT_EQ(lexer::findInvalidUtf8(text), invalid);
+        if (invalid == std::string::npos) {
+            ASSERT_EQ(lexer::utf8ToWideStrict(text), expected);
+        } else {
+            try {
+                lexer::utf8ToWideStrict(text);
+                FAIL();
+            } catch (const lexer::Utf8Error& error) {
+                ASSERT_EQ(error.getOffset(), invalid);
+            }
+        }
+    }
+}
+
+TEST(LexerCharTypesTest, Test_CharTypes_Utf8Stream) {
+    // the characters are cut by the ends of the buffer of the stream
+    std::string utf8;
+    for (size_t i = 0; utf8.size() < 100000; ++i) {
+        utf8 += i % 7 ? "abc + й𝔸 = €;\n" : std::string(i % 50, 'x') + "\n";
+    }
+    std::ofstream fout("test-utf8.txt", std::ios_base::binary);
+    fout << utf8;
+    fout.close();
+
+    auto lexer = makeLexer<wchar_t>({ L"+-/*=<>!" }, L"&?;(){}\n", L" \t",
+                                    lexer::LexerEngine::Dfa);
+    std::wifstream fin("test-utf8.txt");
+    auto tokens = lexer.createTokens(fin);
+    auto expected = lexer.createTokens(lexer::utf8ToWide(utf8));
+    ASSERT_EQ(tokens.getSize(), expected.getSize());
+    for (size_t k = 0; k < expected.getSize(); ++k) {
+        ASSERT_EQ(tokens.getTokenText(k), expected.getTokenText(k));
+    }
+}
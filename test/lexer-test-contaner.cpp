@@ -0,0 +1,391 @@
+#include "../include/lexer/lexer.h"
+#include "lexer-test-helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <thread>
+
+static const std::vector<lexer::CombiningTokens> COMBINING_TOKENS = {
+    lexer::CombiningTokens { lexer::Token(L"\""), lexer::Token(L"\"") },
+    lexer::CombiningTokens { lexer::Token(L"//"), lexer::Token(L"\n") },
+    lexer::CombiningTokens { lexer::Token(L"/*"), lexer::Token(L"*/") }
+};
+
+// counts the allocations that reach the new and delete resource
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+static void expectSameColumns(const lexer::LexerContaner& tokens) {
+    ASSERT_EQ(tokens.getIds().size(), tokens.getSize());
+    size_t k = 0;
+    for (size_t i = 0; i < tokens.getLinesNumber(); ++i) {
+        const lexer::TokenLine& line = tokens[i];
+        ASSERT_EQ(tokens.getLineNumber(i), line.line_number);
+        ASSERT_EQ(tokens.getOriginal(i), line.original);
+        auto ids = tokens.getLineIds(i);
+        ASSERT_EQ(ids.size(), line.tokens.size());
+        for (size_t j = 0; j < line.tokens.size(); ++j, ++k) {
+            ASSERT_EQ(ids[j], line.tokens[j].getId());
+            ASSERT_EQ(tokens.getIds()[k], line.tokens[j].getId());
+            ASSERT_EQ(tokens.getTokenText(k), line.tokens[j].getText());
+        }
+    }
+    ASSERT_EQ(k, tokens.getSize());
+}
+
+TEST(LexerContanerTest, Test_Contaner_Columns) {
+    std::mt19937 random(3);
+    for (auto engine : { lexer::Lexer::Engine::Classic, lexer::Lexer::Engine::Dfa }) {
+        lexer::Lexer lexer({ L"+-/*=<>!", L"йb" }, L"&?;(){}\n", COMBINING_TOKENS,
+                           L" \t", lexer::defineTokenId<uint64_t>, engine);
+        for (size_t n = 0; n < 50; ++n) {
+            std::wstring code = randomCode(random, 200);
+            expectSameColumns(lexer.createTokens(code));
+            expectSameColumns(lexer.createTokens(lexer::wideToUtf8(code)));
+        }
+    }
+}
+
+TEST(LexerContanerTest, Test_Contaner_TokenIndex) {
+    std::mt19937 random(5);
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t");
+    for (size_t n = 0; n < 20; ++n) {
+        auto tokens = lexer.createTokens(randomCode(random, 300));
+        size_t k = 0;
+        for (size_t i = 0; i < tokens.getLinesNumber(); ++i) {
+            ASSERT_EQ(tokens.getLineStart(i), k);
+            for (size_t j = 0; j < tokens[i].tokens.size(); ++j, ++k) {
+                ASSERT_EQ(tokens.locateToken(k), std::make_pair(i, j));
+                ASSERT_EQ(tokens.tokenAt(k), tokens[i].tokens[j]);
+            }
+        }
+        ASSERT_EQ(k, tokens.getSize());
+        ASSERT_EQ(tokens.getLineStart(tokens.getLinesNumber()), k);
+        ASSERT_THROW(tokens.locateToken(k), std::out_of_range);
+        ASSERT_THROW(tokens.tokenAt(k), std::out_of_range);
+
+        // a view visits the same tokens as the whole storage from its first index
+        size_t first = k / 3, last = k - k / 4;
+        auto view = tokens.getRange(first, last);
+        ASSERT_EQ(view.getSize(), last - first);
+        ASSERT_EQ(view.end() - view.begin(), last - first);
+        auto it = tokens.cbegin() + static_cast<std::ptrdiff_t>(first);
+        for (const lexer::Token& token : view) {
+            ASSERT_EQ(token, *it++);
+        }
+        for (size_t i = 0; i < view.getSize(); ++i) {
+            ASSERT_EQ(view.tokenAt(i), tokens.tokenAt(first + i));
+            ASSERT_EQ(view.getIds()[i], tokens.getIds()[first + i]);
+        }
+        ASSERT_THROW(view.tokenAt(view.getSize()), std::out_of_range);
+        ASSERT_THROW(tokens.getRange(last, first - 1), std::out_of_range);
+
+        size_t lines = tokens.getLinesNumber();
+        auto rows = tokens.getLineRange(lines / 2, lines);
+        ASSERT_EQ(rows.getBeginIndex(), tokens.getLineStart(lines / 2));
+        ASSERT_EQ(rows.getEndIndex(), tokens.getSize());
+    }
+    ASSERT_TRUE(lexer::LexerContanerView().empty());
+}
+
+TEST(LexerContanerTest, Test_Contaner_Partition) {
+    std::mt19937 random(7);
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t");
+    auto tokens = lexer.createTokens(randomCode(random, 2000));
+    size_t size = tokens.getSize();
+    for (size_t n : { 1, 3, 7, 64, 5000 }) {
+        for (bool whole_lines : { false, true }) {
+            auto views = tokens.partition(n, whole_lines);
+            ASSERT_EQ(views.size(), n);
+            size_t next = 0;
+            for (const auto& view : views) {
+                ASSERT_EQ(view.getBeginIndex(), next);
+                next = view.getEndIndex();
+                if (!whole_lines) {
+                    ASSERT_LE(view.getSize(), size / n + 1);
+                    ASSERT_GE(view.getSize(), size / n);
+                } else if (view.getBeginIndex() < size) {
+                    ASSERT_EQ(tokens.locateToken(view.getBeginIndex()).second, 0);
+                }
+            }
+            ASSERT_EQ(next, size);
+        }
+    }
+
+    // the views are counted by several threads at once
+    auto views = tokens.partition(4, true);
+    std::vector<size_t> counts(views.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < views.size(); ++i) {
+        threads.emplace_back([&views, &counts, i]() {
+            counts[i] = static_cast<size_t>(
+                std::ranges::count(views[i].getIds(), lexer::defineTokenId(L"a")));
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(std::accumulate(counts.begin(), counts.end(), size_t(0)),
+              tokens.countId(lexer::defineTokenId(L"a")));
+    ASSERT_EQ(lexer::LexerContaner().partition(2).size(), 2);
+}
+
+TEST(LexerContanerTest, Test_Contaner_SharedRows) {
+    // the rows are built once, the threads that ask at once get the same rows
+    std::mt19937 random(5);
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t");
+    auto tokens = lexer.createTokens(randomCode(random, 2000));
+    std::vector<const lexer::TokenLine*> rows(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        threads.emplace_back([&tokens, &rows, i]() { rows[i] = &tokens.getLine(0); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    ASSERT_TRUE(std::ranges::all_of(rows, [&](auto row) { return row == rows[0]; }));
+    static_assert(std::is_same_v<decltype(tokens[0]), const lexer::TokenLine&>);
+
+    // new rows replace the built ones
+    tokens =
+        lexer::lexer_contaner_t { lexer::TokenLine(7, L"z", { lexer::Token(L"z") }) };
+    ASSERT_EQ(tokens.getLinesNumber(), 1);
+    ASSERT_EQ(tokens.getLine(0).line_number, 7);
+    ASSERT_EQ(tokens[0].tokens.at(0).getText(), L"z");
+}
+
+TEST(LexerContanerTest, Test_Contaner_MemoryResource) {
+    std::mt19937 random(9);
+    for (auto engine : { lexer::Lexer::Engine::Classic, lexer::Lexer::Engine::Dfa }) {
+        lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t",
+                           lexer::defineTokenId<uint64_t>, engine);
+        std::wstring code = randomCode(random, 2000);
+        auto expected = lexer.createTokens(code);
+
+        CountingResource counting;
+        std::pmr::monotonic_buffer_resource arena(1 << 12, &counting);
+        auto tokens = lexer.createTokens(code, &arena);
+        auto utf8_tokens = lexer.createTokens(lexer::wideToUtf8(code), &arena);
+        ASSERT_EQ(tokens.getMemoryResource(), &arena);
+        ASSERT_EQ(utf8_tokens.getMemoryResource(), &arena);
+        ASSERT_GT(counting.allocations, 0);
+        ASSERT_TRUE(std::ranges::equal(tokens.getIds(), expected.getIds()));
+        ASSERT_TRUE(std::ranges::equal(utf8_tokens.getIds(), expected.getIds()));
+        expectSameColumns(tokens);
+
+        // walking the tokens takes nothing from the resource, the rows come from it
+        CountingResource rows_counting;
+        auto counted = lexer.createTokens(code, &rows_counting);
+        size_t allocations = rows_counting.allocations;
+        ASSERT_TRUE(std::ranges::equal(counted, expected));
+        ASSERT_TRUE(std::ranges::equal(counted.unchecked(), expected));
+        ASSERT_EQ(rows_counting.allocations, allocations);
+        ASSERT_EQ(counted.getLine(0), expected.getLine(0));
+        ASSERT_GT(rows_counting.allocations, allocations);
+
+        // a copy does not depend on the arena
+        lexer::LexerContaner copy = tokens;
+        ASSERT_EQ(copy.getMemoryResource(), std::pmr::get_default_resource());
+        ASSERT_EQ(copy.getLinesNumber(), expected.getLinesNumber());
+    }
+
+    // the chunks lexed by several threads are gathered in the arena
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t");
+    std::wstring code = randomCode(random, 600000);
+    auto expected = lexer.createTokens(code);
+    lexer.setThreadsNumber(3);
+    std::pmr::monotonic_buffer_resource arena;
+    auto tokens = lexer.createTokens(code, &arena);
+    ASSERT_EQ(tokens.getMemoryResource(), &arena);
+    ASSERT_TRUE(std::ranges::equal(tokens.getIds(), expected.getIds()));
+    ASSERT_EQ(tokens.getLinesNumber(), expected.getLinesNumber());
+    for (size_t i = 0; i < tokens.getLinesNumber(); ++i) {
+        ASSERT_EQ(tokens.getLineNumber(i), expected.getLineNumber(i));
+        ASSERT_EQ(tokens.getLineStart(i), expected.getLineStart(i));
+    }
+}
+
+TEST(LexerContanerTest, Test_Contaner_CountId) {
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t");
+    auto tokens = lexer.createTokens(L"a = b;\nif (a) a = 1;\n");
+
+    ASSERT_EQ(tokens.countId(lexer::defineTokenId(L"a")), 3);
+    ASSERT_EQ(tokens.countId(lexer::defineTokenId(L";")), 2);
+    ASSERT_EQ(tokens.countId(lexer::defineTokenId(L"while")), 0);
+    ASSERT_EQ(tokens.getLineIds(1).size(), 9);
+}
+
+TEST(LexerContanerTest, Test_Contaner_FromLines) {
+    lexer::lexer_contaner_t lines = {
+        lexer::TokenLine(1, L"x = 1\n", { lexer::Token(L"x"), lexer::Token(L"="),
+                                          lexer::Token(L"1"), lexer::Token(L"\n") }),
+        lexer::TokenLine(3, L"y", { lexer::Token(L"y") })
+    };
+    lexer::LexerContaner tokens(lines);
+    expectSameColumns(tokens);
+    ASSERT_EQ(tokens.getSize(), 5);
+    ASSERT_EQ(tokens.getTokenText(4), L"y");
+    ASSERT_EQ(tokens.getLineNumber(1), 3);
+    ASSERT_TRUE(tokens.getSource().empty());
+}
+
+TEST(LexerContanerTest, Test_Contaner_CopyOutlivesOriginal) {
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t");
+    lexer::LexerContaner copy;
+    {
+        auto tokens = lexer.createTokens(L"first /* comment */ second\n");
+        ASSERT_EQ(tokens[0].tokens.at(2).getText(), L" comment ");
+        copy = tokens;
+    }
+    ASSERT_EQ(copy[0].tokens.at(2).getText(), L" comment ");
+    ASSERT_EQ(copy.getLine(0).original, L"first /* comment */ second\n");
+    expectSameColumns(copy);
+}
+
+TEST(LexerContanerTest, Test_Contaner_Interner) {
+    lexer::TokenInterner interner;
+    auto a = interner.intern(L"alpha");
+    auto b = interner.intern(L"beta");
+    ASSERT_EQ(a, 0);
+    ASSERT_EQ(b, 1);
+    ASSERT_EQ(interner.intern(L"alpha"), a);
+    ASSERT_EQ(interner.find(L"gamma"), lexer::TokenInterner::NO_SYMBOL);
+    ASSERT_EQ(interner.getText(b), L"beta");
+
+    // equal hashes of different texts give different ids
+    auto c = interner.intern(L"gamma", 42);
+    auto d = interner.intern(L"delta", 42);
+    ASSERT_NE(c, d);
+    ASSERT_EQ(interner.intern(L"delta", 42), d);
+    ASSERT_EQ(interner.getSize(), 4);
+
+    std::wstring long_text(lexer::TokenInterner::BLOCK_SIZE, L'x');
+    auto e = interner.intern(long_text);
+    ASSERT_EQ(interner.getText(e), long_text);
+    ASSERT_EQ(interner.getText(a), L"alpha");
+
+    // hashes that differ only in their high bits are spread over the table
+    lexer::TokenInterner high_bits;
+    for (uint64_t i = 0; i < 1000; ++i) {
+        ASSERT_EQ(high_bits.intern(std::to_wstring(i), i << 40), i);
+    }
+    for (uint64_t i = 0; i < 1000; ++i) {
+        ASSERT_EQ(high_bits.find(std::to_wstring(i), i << 40), i);
+    }
+}
+
+TEST(LexerContanerTest, Test_Contaner_ConcurrentInterner) {
+    // the threads intern the same texts in different orders while the table grows
+    lexer::TokenInterner interner;
+    const size_t texts = 5000;
+    std::vector<std::vector<lexer::TokenInterner::symbol_t>> symbols(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < symbols.size(); ++t) {
+        threads.emplace_back([&, t]() {
+            symbols[t].resize(texts);
+            for (size_t n = 0; n < texts; ++n) {
+                size_t i = t % 2 == 0 ? n : texts - 1 - n;
+                symbols[t][i] = interner.intern(std::to_wstring(i));
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(interner.getSize(), texts);
+    for (size_t i = 0; i < texts; ++i) {
+        for (size_t t = 1; t < symbols.size(); ++t) {
+            ASSERT_EQ(symbols[t][i], symbols[0][i]);
+        }
+        ASSERT_LT(symbols[0][i], texts);
+        ASSERT_EQ(interner.getText(symbols[0][i]), std::to_wstring(i));
+        ASSERT_EQ(interner.find(std::to_wstring(i)), symbols[0][i]);
+    }
+}
+
+TEST(LexerContanerTest, Test_Contaner_InternedTokens) {
+    auto interner = std::make_shared<lexer::TokenInterner>();
+    std::mt19937 random(9);
+    for (auto engine : { lexer::Lexer::Engine::Classic, lexer::Lexer::Engine::Dfa }) {
+        lexer::Lexer lexer({ L"+-/*=<>!", L"йb" }, L"&?;(){}\n", COMBINING_TOKENS,
+                           L" \t", lexer::defineTokenId<uint64_t>, engine);
+        lexer::Lexer interning = lexer;
+        interning.setInterner(interner);
+        ASSERT_EQ(interning.getInterner(), interner);
+
+        for (size_t n = 0; n < 20; ++n) {
+            std::wstring code = randomCode(random, 200);
+            auto expected = lexer.createTokens(code);
+            auto actual = interning.createTokens(code);
+            expectSameColumns(actual);
+            ASSERT_EQ(actual.getInterner(), interner);
+            ASSERT_EQ(actual.getSymbols().size(), expected.getSize());
+
+            for (size_t k = 0; k < expected.getSize(); ++k) {
+                ASSERT_EQ(actual.getTokenText(k), expected.getTokenText(k));
+                ASSERT_EQ(interner->getText(actual.getSymbols()[k]),
+                          expected.getTokenText(k));
+            }
+            // equal texts share a symbol, the tokens still refer to the container text
+            for (size_t k = 0; k < actual.getSize(); ++k) {
+                ASSERT_EQ(interner->find(actual.getTokenText(k)), actual.getSymbols()[k]);
+                ASSERT_EQ(actual.tokenAt(k).getText().data(),
+                          actual.getTokenText(k).data());
+            }
+        }
+    }
+}
+
+TEST(LexerContanerTest, Test_Contaner_CollidingIds) {
+    // all tokens get the same id, the texts still tell them apart
+    auto sameId = [](const wchar_t*) -> uint64_t { return 7; };
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t", sameId);
+    lexer.setInterner(std::make_shared<lexer::TokenInterner>());
+    auto tokens = lexer.createTokens(L"a b a c\n");
+
+    auto symbols = tokens.getSymbols();
+    ASSERT_EQ(symbols.size(), 5);
+    ASSERT_EQ(symbols[0], symbols[2]);
+    ASSERT_NE(symbols[0], symbols[1]);
+    ASSERT_NE(symbols[1], symbols[3]);
+    ASSERT_EQ(tokens[0].tokens[0], tokens[0].tokens[2]);
+    ASSERT_NE(tokens[0].tokens[0], tokens[0].tokens[1]);
+    ASSERT_NE(lexer::Token(sameId, L"x"), lexer::Token(sameId, L"y"));
+}
+
+TEST(LexerContanerTest, Test_Contaner_AppendConverted) {
+    lexer::BasicLexerContanerBuilder<char16_t> builder;
+    size_t offset = builder.appendText(u"x");
+    ASSERT_EQ(builder.appendConverted(std::string_view("a\xD0\xB9\xF0\x9F\x98\x80")), 1);
+    ASSERT_EQ(builder.getCopy(offset), u"xaй\U0001F600");
+    ASSERT_EQ(builder.getCopy(1), u"aй\U0001F600");
+
+    // an invalid sequence is decoded as U+FFFD like by utf8ToWide
+    lexer::BasicLexerContanerBuilder<wchar_t> wide;
+    wide.appendConverted(std::string_view("b\xFF"));
+    ASSERT_EQ(wide.getCopy(0), lexer::utf8ToWide("b\xFF"));
+
+    lexer::BasicLexerContanerBuilder<char8_t> utf8;
+    utf8.appendConverted(std::u16string_view(u"й\U0001F600"));
+    ASSERT_EQ(utf8.getCopy(0), u8"й\U0001F600");
+}
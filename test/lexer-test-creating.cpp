@@ -1,7 +1,13 @@
 #include "../include/lexer/lexer.h"
+#include "../include/lexer/file-batch-reader.h"
+#include "../include/lexer/mapped-file.h"
+#include "../include/lexer/work-stealing-pool.h"
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <numeric>
+
 static const std::vector<lexer::CombiningTokens> COMBINING_TOKENS = {
     lexer::CombiningTokens { lexer::Token(L"\""), lexer::Token(L"\"") },
     lexer::CombiningTokens { lexer::Token(L"//"), lexer::Token(L"\n") },
@@ -421,3 +427,276 @@ TEST(LexerTest, Test_Creating_9_ManyRowsFromFile) {
     ASSERT_EQ(tokens.getLine(7).tokens.at(2).getId(), lexer::defineTokenId(L"*/"));
     ASSERT_EQ(tokens.getLine(7).tokens.at(2).getText(), L"*/");
 }
+
+TEST(LexerTest, Test_Creating_10_SeveralAlphabets) {
+    lexer::Lexer lexer({ L"+-/*=<>!", L"0123456789",
+                         L"абвгдеёжзийклмнопрстуфхцчшщъыьэюя" },
+                       L";\n", {}, L" \t");
+    auto tokens = lexer.createTokens(L"x1>=42 привет5;\n");
+
+    ASSERT_EQ(tokens.getSize(), 8);
+    ASSERT_EQ(tokens.getLinesNumber(), 1);
+    ASSERT_EQ(tokens.getLine(0).tokens.at(0).getText(), L"x");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(1).getText(), L"1");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(2).getText(), L">=");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(3).getText(), L"42");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(4).getText(), L"привет");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(5).getText(), L"5");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(6).getText(), L";");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(7).getText(), L"\n");
+}
+
+TEST(LexerTest, Test_Creating_11_MappedFile) {
+    std::ofstream fout("test-mapped.txt", std::ios_base::binary);
+    fout << "int привет = 5; // comment\n/* a\nb */ x\n";
+    fout.close();
+
+    lexer::MappedFile file("test-mapped.txt");
+    ASSERT_TRUE(file.isMapped());
+    ASSERT_EQ(file.getContents(), "int привет = 5; // comment\n/* a\nb */ x\n");
+
+    auto expected =
+        LEXER.createTokens(std::wstring(L"int привет = 5; // comment\n/* a\nb */ x\n"));
+    auto tokens = LEXER.createTokens("test-mapped.txt");
+    ASSERT_EQ(tokens.getLinesNumber(), expected.getLinesNumber());
+    for (size_t i = 0; i < expected.getLinesNumber(); ++i) {
+        ASSERT_EQ(tokens[i], expected[i]);
+    }
+
+    lexer::BasicLexer<char> utf8_lexer({ "+-/*=<>!" }, "&?;(){}\n", {}, " \t");
+    auto utf8_tokens = utf8_lexer.createTokens("test-mapped.txt");
+    ASSERT_EQ(utf8_tokens.getLine(0).tokens.at(1).getText(), "привет");
+
+    ASSERT_THROW(LEXER.createTokens("not-existing-file.txt"), std::runtime_error);
+#ifdef __linux__
+    // the size of a file of /proc is unknown, it is read until the end
+    lexer::MappedFile proc_file("/proc/self/status");
+    ASSERT_FALSE(proc_file.isMapped());
+    ASSERT_TRUE(proc_file.getContents().starts_with("Name:"));
+#endif
+}
+
+TEST(LexerTest, Test_Creating_12_FileBatch) {
+    std::vector<std::string> file_names;
+    std::vector<std::wstring> contents;
+    for (size_t i = 0; i < 40; ++i) {
+        file_names.push_back("test-batch-" + std::to_string(i) + ".txt");
+        std::string text;
+        for (size_t j = 0; j <= i * 7; ++j) {
+            text += "int x" + std::to_string(j) + " = " + std::to_string(i) + ";\n";
+        }
+        text += "/* file\n" + std::to_string(i) + " */ привет\n";
+        std::ofstream fout(file_names.back(), std::ios_base::binary);
+        fout << text;
+        contents.push_back(lexer::utf8ToWide(text));
+    }
+
+    for (size_t queue_depth : { 4, 1 }) {
+        // the files are taken in the order their reads complete
+        lexer::FileBatchReader reader(file_names, queue_depth);
+        std::vector<bool> taken(file_names.size(), false);
+        size_t index;
+        std::string text;
+        while (reader.next(index, text)) {
+            ASSERT_FALSE(taken[index]);
+            taken[index] = true;
+            ASSERT_TRUE(lexer::utf8ToWide(text) == contents[index]);
+        }
+        ASSERT_TRUE(std::all_of(taken.begin(), taken.end(), [](bool t) { return t; }));
+    }
+
+    std::vector<std::filesystem::path> paths(file_names.begin(), file_names.end());
+    for (size_t threads : { 1, 3, 0 }) {
+        auto batch = LEXER.createTokensBatch(paths, threads);
+        ASSERT_EQ(batch.size(), file_names.size());
+        for (size_t i = 0; i < file_names.size(); ++i) {
+            auto expected = LEXER.createTokens(contents[i]);
+            ASSERT_EQ(batch[i].getLinesNumber(), expected.getLinesNumber());
+            for (size_t j = 0; j < expected.getLinesNumber(); ++j) {
+                ASSERT_EQ(batch[i][j], expected[j]);
+            }
+        }
+    }
+
+    lexer::BasicLexer<char> utf8_lexer({ "+-/*=<>!" }, "&?;(){}\n", {}, " \t");
+    auto utf8_batch = utf8_lexer.createTokensBatch(paths);
+    ASSERT_EQ(utf8_batch[5].getLine(0).tokens.at(1).getText(), "x0");
+
+    // an unreadable file does not stop the others
+    std::vector<std::string> with_missing = { file_names[0], "not-existing-file.txt",
+                                              file_names[1] };
+    std::vector<std::filesystem::path> missing_paths(with_missing.begin(),
+                                                     with_missing.end());
+    ASSERT_THROW(LEXER.createTokensBatch(missing_paths), std::runtime_error);
+    lexer::FileBatchReader reader(with_missing);
+    size_t index;
+    std::string text;
+    size_t read = 0, failed = 0;
+    for (;;) {
+        try {
+            if (!reader.next(index, text)) {
+                break;
+            }
+            ++read;
+        } catch (const std::runtime_error&) {
+            ASSERT_EQ(index, 1);
+            ++failed;
+        }
+    }
+    ASSERT_EQ(read, 2);
+    ASSERT_EQ(failed, 1);
+    std::span<const std::filesystem::path> no_paths;
+    ASSERT_TRUE(LEXER.createTokensBatch(no_paths).empty());
+}
+
+TEST(LexerTest, Test_Creating_13_BufferBatch) {
+    // the sizes differ a lot, so the threads steal the small inputs
+    std::vector<std::wstring> contents;
+    for (size_t i = 0; i < 30; ++i) {
+        std::wstring text;
+        size_t lines = i % 7 == 0 ? 3000 : i;
+        for (size_t j = 0; j <= lines; ++j) {
+            text += L"int x" + std::to_wstring(j) + L" = \"" + std::to_wstring(i) +
+                    L"\";\n";
+        }
+        text += L"/* input\n" + std::to_wstring(i) + L" */ привет";
+        contents.push_back(std::move(text));
+    }
+    std::vector<std::wstring_view> inputs(contents.begin(), contents.end());
+
+    const lexer::Lexer& shared = LEXER;
+    for (size_t threads : { 1, 4, 0 }) {
+        auto batch = shared.createTokensBatch(inputs, threads);
+        ASSERT_EQ(batch.size(), inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            auto expected = shared.createTokens(contents[i]);
+            ASSERT_EQ(batch[i].getLinesNumber(), expected.getLinesNumber());
+            for (size_t j = 0; j < expected.getLinesNumber(); ++j) {
+                ASSERT_EQ(batch[i][j], expected[j]);
+            }
+        }
+    }
+    ASSERT_TRUE(shared.createTokensBatch(std::span<const std::wstring_view>()).empty());
+
+    // every task is run once even if some of them throw
+    std::vector<std::atomic<int>> runs(100);
+    std::vector<size_t> tasks(runs.size());
+    std::iota(tasks.begin(), tasks.end(), 0);
+    lexer::WorkStealingPool pool(3);
+    ASSERT_EQ(pool.getThreadsNumber(), 3);
+    ASSERT_THROW(pool.run(tasks,
+                          [&runs](size_t i) {
+                              ++runs[i];
+                              if (i % 10 == 0) {
+                                  throw std::runtime_error("task failed");
+                              }
+                          }),
+                 std::runtime_error);
+    ASSERT_TRUE(std::all_of(runs.begin(), runs.end(),
+                            [](const std::atomic<int>& r) { return r == 1; }));
+}
+
+TEST(LexerTest, Test_Creating_14_OpenerEndingChar) {
+    // the character that ends an initial token is the first one of the combined text
+    auto tokens = LEXER.createTokens(L"//(c)\n\"x\" /*y*/\n");
+
+    ASSERT_EQ(tokens.getLinesNumber(), 2);
+    ASSERT_EQ(tokens.getLine(0).tokens.size(), 3);
+    ASSERT_EQ(tokens.getLine(0).tokens.at(0).getText(), L"//");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(1).getText(), L"(c)");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(2).getText(), L"\n");
+    ASSERT_EQ(tokens.getLine(1).tokens.at(1).getText(), L"x");
+    ASSERT_EQ(tokens.getLine(1).tokens.at(4).getText(), L"y");
+    ASSERT_EQ(tokens.getLine(1).tokens.at(5).getText(), L"*/");
+}
+
+TEST(LexerTest, Test_Creating_15_UnterminatedLastToken) {
+    // the last token of a text without a final line break keeps its last character
+    auto tokens = LEXER.createTokens(L"return value");
+
+    ASSERT_EQ(tokens.getSize(), 2);
+    ASSERT_EQ(tokens.getLine(0).tokens.at(1).getText(), L"value");
+    ASSERT_EQ(tokens.getLine(0).original, L"return value");
+
+    auto unclosed = LEXER.createTokens(L"x = \"abc");
+    ASSERT_EQ(unclosed.getSize(), 4);
+    ASSERT_EQ(unclosed.getLine(0).tokens.at(3).getText(), L"abc");
+}
+
+TEST(LexerTest, Test_Creating_16_LinesInCombinedText) {
+    // the line breaks inside a combined text are counted in the row numbers
+    auto tokens = LEXER.createTokens(L"/* a\nb\nc */ x\ny\n\"1\n2\"\nz\n");
+
+    ASSERT_EQ(tokens.getLinesNumber(), 4);
+    ASSERT_EQ(tokens.getLine(0).line_number, 1);
+    ASSERT_EQ(tokens.getLine(0).original, L"/* a\nb\nc */ x\n");
+    ASSERT_EQ(tokens.getLine(1).line_number, 4);
+    ASSERT_EQ(tokens.getLine(2).line_number, 5);
+    ASSERT_EQ(tokens.getLine(3).line_number, 7);
+    ASSERT_EQ(tokens.getLine(3).original, L"z\n");
+}
+
+TEST(LexerTest, Test_Creating_17_RowsWithoutTokens) {
+    // a row of separators only is skipped without leaking its text into the next row
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;(){}", COMBINING_TOKENS, L" \t\n");
+    auto tokens = lexer.createTokens(L"a\n \t \nb\n");
+
+    ASSERT_EQ(tokens.getLinesNumber(), 2);
+    ASSERT_EQ(tokens.getLine(0).original, L"a\n");
+    ASSERT_EQ(tokens.getLine(1).line_number, 3);
+    ASSERT_EQ(tokens.getLine(1).original, L"b\n");
+    ASSERT_EQ(tokens.getLine(1).tokens.size(), 1);
+}
+
+TEST(LexerTest, Test_Creating_18_CombiningTokensByText) {
+    // an initial token is found by its text even if every token has the same id
+    auto sameId = [](const wchar_t*) -> uint64_t { return 7; };
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t", sameId);
+    auto tokens = lexer.createTokens(L"a b // c\n");
+
+    ASSERT_EQ(tokens.getSize(), 5);
+    ASSERT_EQ(tokens.getLine(0).tokens.at(1).getText(), L"b");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(2).getText(), L"//");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(3).getText(), L" c");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(3).getId(), 7);
+}
+
+TEST(LexerTest, Test_Creating_19_MovedCombiningTokens) {
+    lexer::CombiningTokens comment(lexer::Token(L"/*"), lexer::Token(L"*/"));
+    lexer::CombiningTokens moved(std::move(comment));
+
+    ASSERT_EQ(moved.start.getText(), L"/*");
+    ASSERT_EQ(moved.end.getText(), L"*/");
+}
+
+TEST(LexerTest, Test_Creating_20_GluedOpenerPrefixId) {
+    // a custom function identifies the text before a glued opener once
+    std::vector<std::wstring> texts;
+    auto recordId = [&texts](const wchar_t* text) -> uint64_t {
+        texts.emplace_back(text);
+        return texts.size();
+    };
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t", recordId);
+    auto tokens = lexer.createTokens(L"a =/* b */\n");
+
+    ASSERT_EQ(tokens.getLine(0).tokens.at(1).getText(), L"=");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(2).getText(), L"/*");
+    ASSERT_EQ(std::ranges::count(texts, std::wstring(L"=")), 1);
+}
+
+TEST(LexerTest, Test_Creating_21_OverlappingAlphabets) {
+    for (auto engine : { lexer::Lexer::Engine::Classic, lexer::Lexer::Engine::Dfa }) {
+        lexer::Lexer lexer({ L"0123456789", L"0123456789abcdef", L"xy", L"yz" }, L"\n",
+                           {}, L" ", lexer::defineTokenId<uint64_t>, engine);
+        auto tokens = lexer.createTokens(L"x = ff00 + 12\nxyz xz 0x\n");
+
+        ASSERT_EQ(tokens.getLinesNumber(), 2);
+        std::vector<std::wstring> texts;
+        for (const auto& token : tokens) {
+            texts.push_back(std::wstring(token.getText()));
+        }
+        ASSERT_EQ(texts, (std::vector<std::wstring> { L"x", L"=", L"ff00", L"+", L"12",
+                                                      L"\n", L"xyz", L"x", L"z", L"0",
+                                                      L"x", L"\n" }));
+    }
+}
@@ -0,0 +1,350 @@
+#include "../include/lexer/lexer.h"
+#include "../include/lexer/delimiter-search.h"
+#include "../include/lexer/unicode.h"
+#include "lexer-test-helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+static lexer::CombiningTokens combining(const wchar_t* start, const wchar_t* end) {
+    return lexer::CombiningTokens { lexer::Token(start), lexer::Token(end) };
+}
+
+static const std::vector<lexer::CombiningTokens> COMBINING_TOKENS = {
+    combining(L"\"", L"\""), combining(L"//", L"\n"), combining(L"/*", L"*/")
+};
+
+TEST(LexerEngineTest, Test_Engine_Default) {
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;$#@^:\"'|.,(){}[]\n", COMBINING_TOKENS,
+                       L" \t");
+    ASSERT_EQ(lexer.getEngine(), lexer::Lexer::Engine::Classic);
+    lexer.setEngine(lexer::Lexer::Engine::Dfa);
+    ASSERT_EQ(lexer.getEngine(), lexer::Lexer::Engine::Dfa);
+}
+
+TEST(LexerEngineTest, Test_Engine_LastToken) {
+    for (auto engine : { lexer::Lexer::Engine::Classic, lexer::Lexer::Engine::Dfa }) {
+        lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;$#@^:\"'|.,(){}[]\n", COMBINING_TOKENS,
+                           L" \t", lexer::defineTokenId<uint64_t>, engine);
+        auto tokens = lexer.createTokens(L"return value");
+
+        ASSERT_EQ(tokens.getSize(), 2);
+        ASSERT_EQ(tokens.getLine(0).tokens.at(1).getText(), L"value");
+    }
+}
+
+TEST(LexerEngineTest, Test_Engine_CommentAfterOpener) {
+    for (auto engine : { lexer::Lexer::Engine::Classic, lexer::Lexer::Engine::Dfa }) {
+        lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;$#@^:\"'|.,(){}[]\n", COMBINING_TOKENS,
+                           L" \t", lexer::defineTokenId<uint64_t>, engine);
+        auto tokens = lexer.createTokens(L"//(comment)\n/* a\nb*/ x\n");
+
+        ASSERT_EQ(tokens.getSize(), 8);
+        ASSERT_EQ(tokens.getLinesNumber(), 2);
+        ASSERT_EQ(tokens.getLine(0).line_number, 1);
+        ASSERT_EQ(tokens.getLine(0).tokens.at(1).getText(), L"(comment)");
+        ASSERT_EQ(tokens.getLine(0).tokens.at(2).getText(), L"\n");
+        ASSERT_EQ(tokens.getLine(1).line_number, 2);
+        ASSERT_EQ(tokens.getLine(1).original, L"/* a\nb*/ x\n");
+        ASSERT_EQ(tokens.getLine(1).tokens.at(1).getText(), L" a\nb");
+        ASSERT_EQ(tokens.getLine(1).tokens.at(3).getText(), L"x");
+    }
+}
+
+TEST(LexerEngineTest, Test_Engine_LinesAfterComment) {
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;$#@^:\"'|.,(){}[]\n", COMBINING_TOKENS,
+                       L" \t");
+    auto tokens = lexer.createTokens(L"/* a\nb\nc */\n\nx\n");
+
+    ASSERT_EQ(tokens.getLinesNumber(), 3);
+    ASSERT_EQ(tokens.getLine(1).line_number, 4);
+    ASSERT_EQ(tokens.getLine(2).line_number, 5);
+    ASSERT_EQ(tokens.getLine(2).original, L"x\n");
+}
+
+TEST(LexerEngineTest, Test_Engine_GluedOpener) {
+    std::vector<lexer::CombiningTokens> combining_tokens = COMBINING_TOKENS;
+    combining_tokens.push_back(combining(L"rem", L"\n"));
+    for (auto engine : { lexer::Lexer::Engine::Classic, lexer::Lexer::Engine::Dfa }) {
+        lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;$#@^:\"'|.,(){}[]\n", combining_tokens,
+                           L" \t", lexer::defineTokenId<uint64_t>, engine);
+        auto tokens = lexer.createTokens(L"x//c\na=/*b*/\nremove\n");
+
+        ASSERT_EQ(tokens.getLinesNumber(), 3);
+        ASSERT_EQ(tokens.getLine(0).tokens.size(), 4);
+        ASSERT_EQ(tokens.getLine(0).tokens.at(0).getText(), L"x");
+        ASSERT_EQ(tokens.getLine(0).tokens.at(1).getText(), L"//");
+        ASSERT_EQ(tokens.getLine(0).tokens.at(2).getText(), L"c");
+        ASSERT_EQ(tokens.getLine(1).tokens.size(), 6);
+        ASSERT_EQ(tokens.getLine(1).tokens.at(1).getText(), L"=");
+        ASSERT_EQ(tokens.getLine(1).tokens.at(2).getText(), L"/*");
+        ASSERT_EQ(tokens.getLine(1).tokens.at(3).getText(), L"b");
+        ASSERT_EQ(tokens.getLine(2).tokens.size(), 2);
+        ASSERT_EQ(tokens.getLine(2).tokens.at(0).getText(), L"remove");
+    }
+}
+
+TEST(LexerEngineTest, Test_Engine_Utf8) {
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;$#@^:\"'|.,(){}[]\n", COMBINING_TOKENS,
+                       L" \t");
+    auto tokens = lexer.createTokens(u8"имя = \"значение\"; // комментарий\n");
+
+    ASSERT_EQ(tokens.getLinesNumber(), 1);
+    ASSERT_EQ(tokens.getLine(0).original, L"имя = \"значение\"; // комментарий\n");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(0).getText(), L"имя");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(3).getText(), L"значение");
+    ASSERT_EQ(tokens.getLine(0).tokens.at(7).getText(), L" комментарий");
+    ASSERT_EQ(lexer.createTokens(std::string("a\xFF;")).getLine(0).tokens.at(0).getText(),
+              L"a\xFFFD");
+}
+
+TEST(LexerEngineTest, Test_Engine_SameTokens) {
+    std::vector<lexer::Lexer> lexers = {
+        lexer::Lexer({ L"+-/*=<>!" }, L"&?;$#@^:\"'|.,(){}[]\n", COMBINING_TOKENS,
+                     L" \t"),
+        lexer::Lexer({ L"+-/*=<>!", L"1" }, L"(;", COMBINING_TOKENS, L" \t\n"),
+        lexer::Lexer({ L"+-=<!\n", L"*/" }, L"(\"", COMBINING_TOKENS, L"\t"),
+        lexer::Lexer({}, L"", COMBINING_TOKENS, L" "),
+        lexer::Lexer({ L"+-/*=<>!" }, L"\n",
+                     { combining(L"a", L"aab"), combining(L"<!", L"-\n"),
+                       combining(L"b1", L";") },
+                     L" "),
+        lexer::Lexer({ L"+-/*=<>!" }, L"\"(\n",
+                     { combining(L"--", L"\n"), combining(L"/*", L"*/"),
+                       combining(L"/**", L"*/"), combining(L"<!-", L"-"),
+                       combining(L"=/", L";"), combining(L"ab", L"b"),
+                       combining(L"\"", L"\"") },
+                     L" \t"),
+        lexer::Lexer({ L"+-/*=<>!", L"йb" }, L"\n", { combining(L"й/", L"й") }, L" \t")
+    };
+
+    std::mt19937 random(2024);
+    for (auto& lexer : lexers) {
+        for (size_t i = 0; i < 2000; ++i) {
+            std::wstring code = randomCode(random, i % 40);
+            lexer.setEngine(lexer::Lexer::Engine::Classic);
+            auto expected = lexer.createTokens(code);
+            lexer.setEngine(lexer::Lexer::Engine::Dfa);
+            auto actual = lexer.createTokens(code);
+            expectSameTokens(expected, actual, code);
+            auto utf8_actual = lexer.createTokens(lexer::wideToUtf8(code));
+            expectSameTokens(expected, utf8_actual, code);
+        }
+    }
+}
+
+TEST(LexerEngineTest, Test_Engine_SimdSameTokens) {
+    lexer::LexerDfa dfa({ L"+-/*=<>!" }, L"&?;$#@^:\"'|.,(){}[]\n", COMBINING_TOKENS,
+                        L" \t");
+    lexer::LexerDfa scalar_dfa = dfa;
+    scalar_dfa.setSimdEnabled(false);
+
+    std::mt19937 random(17);
+    std::uniform_int_distribution<size_t> run_length(0, 150);
+    for (size_t i = 0; i < 300; ++i) {
+        std::wstring code;
+        while (code.size() < i * 5) {
+            code += randomCode(random, 3);
+            code.append(run_length(random), i % 2 ? L'x' : L' ');
+            code.append(run_length(random) % 3, L'ы');
+        }
+        auto expected = scalar_dfa.createTokens(code, lexer::defineTokenId<uint64_t>);
+        auto actual = dfa.createTokens(code, lexer::defineTokenId<uint64_t>);
+        expectSameTokens(expected, actual, code);
+        auto utf8_actual =
+            dfa.createTokens(lexer::wideToUtf8(code), lexer::defineTokenId<uint64_t>);
+        expectSameTokens(expected, utf8_actual, code);
+    }
+}
+
+TEST(LexerEngineTest, Test_Engine_SimdLexer) {
+    // the Dfa engine of Lexer skips the runs with vector operations, Classic does not
+    lexer::Lexer classic({ L"+-/*=<>!" }, L"&?;$#@^:\"'|.,(){}[]\n", COMBINING_TOKENS,
+                         L" \t");
+    lexer::Lexer dfa = classic;
+    dfa.setEngine(lexer::Lexer::Engine::Dfa);
+
+    std::mt19937 random(23);
+    std::uniform_int_distribution<size_t> run_length(0, 300);
+    for (size_t i = 0; i < 100; ++i) {
+        std::wstring code;
+        while (code.size() < i * 20) {
+            code += randomCode(random, 4);
+            code.append(run_length(random), i % 2 ? L'x' : L' ');
+            code.append(run_length(random) % 5, L'ы');
+            code.append(run_length(random) % 70, L'\t');
+        }
+        auto expected = classic.createTokens(code);
+        expectSameTokens(expected, dfa.createTokens(code), code);
+        expectSameTokens(expected, dfa.createTokens(lexer::wideToUtf8(code)), code);
+    }
+}
+
+TEST(LexerEngineTest, Test_Engine_FindDelimiter) {
+    ASSERT_EQ(lexer::findDelimiter(L"abc\"de", L"\""), 3);
+    ASSERT_EQ(lexer::findDelimiter(L"abcde", L"\""), std::wstring_view::npos);
+    ASSERT_EQ(lexer::findDelimiter(L"a*b**/c*/", L"*/"), 4);
+    ASSERT_EQ(lexer::findDelimiter(L"a*b*", L"*/"), std::wstring_view::npos);
+    ASSERT_EQ(lexer::findDelimiter(L"--x-->", L"-->"), 3);
+    ASSERT_EQ(lexer::findDelimiter(L"", L"*/"), std::wstring_view::npos);
+}
+
+TEST(LexerEngineTest, Test_Engine_LongComment) {
+    std::wstring comment(100000, L'x');
+    for (size_t i = 0; i < comment.size(); i += 1000) {
+        comment[i] = i % 3000 ? L'*' : L'\n';
+    }
+    for (auto engine : { lexer::Lexer::Engine::Classic, lexer::Lexer::Engine::Dfa }) {
+        lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;$#@^:\"'|.,(){}[]\n", COMBINING_TOKENS,
+                           L" \t", lexer::defineTokenId<uint64_t>, engine);
+        auto tokens = lexer.createTokens(L"a /*" + comment + L"*/ b\nc\n");
+
+        ASSERT_EQ(tokens.getLinesNumber(), 2);
+        ASSERT_EQ(tokens.getLine(0).tokens.at(2).getText(), comment);
+        ASSERT_EQ(tokens.getLine(0).tokens.at(4).getText(), L"b");
+        ASSERT_EQ(tokens.getLine(1).line_number, 2 + comment.size() / 3000 + 1);
+    }
+}
+
+TEST(LexerEngineTest, Test_Engine_IncrementalIds) {
+    static_assert(lexer::updateTextId<uint64_t>(lexer::TEXT_ID_BASIS<uint64_t>, L'a') ==
+                  lexer::defineTokenId(L"a"));
+    std::vector<lexer::Lexer> lexers = {
+        lexer::Lexer({ L"+-/*=<>!" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t"),
+        lexer::Lexer({ L"+-/*=<>!" }, L"\"(\n",
+                     { combining(L"--", L"\n"), combining(L"=/", L";"),
+                       combining(L"ab", L"b"), combining(L"\"", L"\"") },
+                     L" \t")
+    };
+
+    // the ids calculated while the tokens are read are the hashes of their texts
+    std::mt19937 random(13);
+    for (auto& lexer : lexers) {
+        for (auto engine : { lexer::Lexer::Engine::Classic, lexer::Lexer::Engine::Dfa }) {
+            lexer.setEngine(engine);
+            for (size_t i = 0; i < 300; ++i) {
+                std::wstring code = randomCode(random, i % 60);
+                for (const auto& tokens :
+                     { lexer.createTokens(code),
+                       lexer.createTokens(code + L"/* " + code) }) {
+                    for (size_t k = 0; k < tokens.getSize(); ++k) {
+                        ASSERT_EQ(tokens.getIds()[k],
+                                  lexer::defineTextId<uint64_t>(tokens.getTokenText(k)))
+                            << code;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(LexerEngineTest, Test_Engine_ZeroCopy) {
+    std::mt19937 random(5);
+    for (auto engine : { lexer::Lexer::Engine::Classic, lexer::Lexer::Engine::Dfa }) {
+        lexer::Lexer lexer({ L"+-/*=<>!", L"йb" }, L"&?;(){}\n", COMBINING_TOKENS,
+                           L" \t", lexer::defineTokenId<uint64_t>, engine);
+        lexer::Lexer views = lexer;
+        views.setZeroCopy(true);
+        ASSERT_FALSE(lexer.isZeroCopy());
+        ASSERT_TRUE(views.isZeroCopy());
+
+        for (size_t n = 0; n < 100; ++n) {
+            std::wstring code = randomCode(random, 200);
+            auto expected = lexer.createTokens(code);
+            lexer::LexerContaner actual;
+            {
+                // the tokens outlive the string they were created from
+                std::wstring copy = code;
+                actual = views.createTokens(std::move(copy));
+            }
+            expectSameTokens(expected, actual, code);
+            expectSameTokens(expected, views.createTokens(lexer::wideToUtf8(code)), code);
+
+            std::wstring_view source = actual.getSource();
+            ASSERT_EQ(source, code);
+            for (const auto& token : actual) {
+                ASSERT_TRUE(token.isView());
+                ASSERT_GE(token.getText().data(), source.data());
+                ASSERT_LE(token.getText().data() + token.getText().size(),
+                          source.data() + source.size());
+            }
+        }
+    }
+}
+
+TEST(LexerEngineTest, Test_Engine_IdsCalculatedOnce) {
+    static size_t calls = 0;
+    auto countingId = [](const wchar_t* token) {
+        ++calls;
+        return lexer::defineTokenId<uint64_t>(token);
+    };
+    ASSERT_LE(sizeof(lexer::Token),
+              sizeof(uint64_t) + sizeof(std::wstring) + sizeof(std::wstring_view));
+
+    for (auto engine : { lexer::Lexer::Engine::Classic, lexer::Lexer::Engine::Dfa }) {
+        lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t",
+                           countingId, engine);
+        calls = 0;
+        auto tokens = lexer.createTokens(L"a += \"b c\" /* d */ e;\nf\n");
+        ASSERT_EQ(calls, tokens.getSize());
+
+        // copies and moves keep the ids
+        lexer::LexerContaner copy = tokens;
+        lexer::LexerContaner moved = std::move(copy);
+        lexer::Token token = moved.getLine(0).tokens.at(0);
+        token = moved.getLine(0).tokens.at(1);
+        ASSERT_EQ(calls, tokens.getSize());
+        ASSERT_EQ(token.getId(), lexer::defineTokenId(L"+="));
+    }
+}
+
+TEST(LexerEngineTest, Test_Engine_ParallelChunks) {
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;$#@^:\"'|.,(){}[]\n", COMBINING_TOKENS,
+                       L" \t");
+    ASSERT_EQ(lexer.getThreadsNumber(), 1);
+
+    std::mt19937 random(7);
+    std::vector<std::wstring> codes = { randomCode(random, 1 << 20) };
+    // a comment and a string that span several chunks
+    std::wstring lines;
+    for (size_t i = 0; i < 40000; ++i) {
+        lines += L"x = " + std::to_wstring(i) + L";\n";
+    }
+    codes.push_back(L"a /* " + lines + L" */ b\n" + lines + L"\"" + lines + L"\" c");
+    codes.push_back(lines + L"// tail");
+
+    for (const std::wstring& code : codes) {
+        lexer.setThreadsNumber(1);
+        auto expected = lexer.createTokens(code);
+        for (size_t threads : { 2, 3, 8 }) {
+            lexer.setThreadsNumber(threads);
+            ASSERT_EQ(lexer.getThreadsNumber(), threads);
+            expectSameTokens(expected, lexer.createTokens(code), L"");
+        }
+    }
+
+    // the threads are kept when the configuration changes
+    lexer.setThreadsNumber(4);
+    lexer.addIndividualChar(L'~');
+    ASSERT_EQ(lexer.getThreadsNumber(), 4);
+    lexer.setThreadsNumber(0);
+    ASSERT_GE(lexer.getThreadsNumber(), 1);
+
+    // UTF-8 tokens and interned texts
+    lexer::BasicLexer<char> utf8_lexer({ "+-/*=<>!" }, "&?;$#@^:\"'|.,(){}[]\n",
+                                       { { lexer::BasicToken<char>("/*"),
+                                           lexer::BasicToken<char>("*/") } },
+                                       " \t");
+    utf8_lexer.setInterner(std::make_shared<lexer::BasicTokenInterner<char>>());
+    std::string utf8_code = lexer::wideToUtf8(codes[1]);
+    auto utf8_expected = utf8_lexer.createTokens(utf8_code);
+    utf8_lexer.setInterner(std::make_shared<lexer::BasicTokenInterner<char>>());
+    utf8_lexer.setThreadsNumber(6);
+    auto utf8_tokens = utf8_lexer.createTokens(utf8_code);
+    ASSERT_EQ(utf8_tokens.getLinesNumber(), utf8_expected.getLinesNumber());
+    ASSERT_TRUE(std::ranges::equal(utf8_tokens.getSymbols(), utf8_expected.getSymbols()));
+    for (size_t i = 0; i < utf8_expected.getLinesNumber(); ++i) {
+        ASSERT_EQ(utf8_tokens[i], utf8_expected[i]);
+    }
+}
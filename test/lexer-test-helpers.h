@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../include/lexer/lexer.h"
+#include "../include/lexer/unicode.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <type_traits>
+
+// letters, digits, operators, openers, separators and a character out of ASCII
+inline const std::wstring RANDOM_CODE_CHARS = L"ab1+-/*=<!\"(;\n\n \tй";
+
+inline std::wstring randomCode(std::mt19937& random, size_t length,
+                               const std::wstring& chars = RANDOM_CODE_CHARS) {
+    std::uniform_int_distribution<size_t> distribution(0, chars.size() - 1);
+    std::wstring code;
+    for (size_t i = 0; i < length; ++i) {
+        code.push_back(chars[distribution(random)]);
+    }
+    return code;
+}
+
+// compares the rows and tokens with the ones of a wide container, the texts of other
+// character types are compared after the conversion and their ids are hashed anew
+template <class CharT>
+void expectSameTokens(const lexer::LexerContaner& expected,
+                      const lexer::BasicLexerContaner<CharT>& actual,
+                      const std::wstring& code) {
+    ASSERT_EQ(expected.getTokensNumber(), actual.getTokensNumber()) << code;
+    ASSERT_EQ(expected.getLinesNumber(), actual.getLinesNumber()) << code;
+    for (size_t i = 0; i < expected.getLinesNumber(); ++i) {
+        ASSERT_EQ(expected[i].line_number, actual[i].line_number) << code;
+        ASSERT_EQ(expected[i].original,
+                  lexer::toWide(std::basic_string_view<CharT>(actual[i].original)))
+            << code;
+        ASSERT_EQ(expected[i].tokens.size(), actual[i].tokens.size()) << code;
+        for (size_t j = 0; j < expected[i].tokens.size(); ++j) {
+            const std::basic_string<CharT> text(actual[i].tokens[j].getText());
+            ASSERT_EQ(expected[i].tokens[j].getText(),
+                      lexer::toWide(std::basic_string_view<CharT>(text)))
+                << code;
+            if constexpr (std::is_same_v<CharT, wchar_t>) {
+                ASSERT_EQ(expected[i].tokens[j].getId(), actual[i].tokens[j].getId())
+                    << code;
+            } else {
+                ASSERT_EQ(actual[i].tokens[j].getId(),
+                          lexer::defineTokenId<uint64_t>(text.c_str()))
+                    << code;
+            }
+        }
+    }
+}
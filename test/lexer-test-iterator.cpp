@@ -1354,3 +1354,115 @@ TEST(TestLexer, Test_ConstReverseIterator_All) {
         ++i;
     }
 }
+
+TEST(TestLexer, Test_Iterator_RandomAccess) {
+    const std::wstring test_code = L"hello world\n"
+                                   "10 * name\n"
+                                   "\n"
+                                   "return\tfalse;\n"
+                                   "/* one more comment\n"
+                                   "next comment line*/ end";
+    auto tokens = LEXER.createTokens(test_code);
+    const auto& const_tokens = tokens;
+    ASSERT_EQ(tokens.end() - tokens.begin(), tokens.getSize());
+    ASSERT_EQ(tokens.rend() - tokens.rbegin(), tokens.getSize());
+
+    std::vector<lexer::Token> forward;
+    for (auto it = tokens.cbegin(); it != tokens.cend(); ++it) {
+        forward.push_back(*it);
+    }
+    ASSERT_EQ(forward.size(), tokens.getSize());
+
+    auto ptrdiff = [](size_t n) { return static_cast<std::ptrdiff_t>(n); };
+    for (size_t i = 0; i < forward.size(); ++i) {
+        ASSERT_EQ(*(tokens.begin() + ptrdiff(i)), forward[i]);
+        ASSERT_EQ(const_tokens.begin()[ptrdiff(i)], forward[i]);
+        ASSERT_EQ(*(tokens.end() - ptrdiff(forward.size() - i)), forward[i]);
+        ASSERT_EQ(tokens.rbegin()[ptrdiff(forward.size() - 1 - i)], forward[i]);
+        ASSERT_EQ(*(const_tokens.rend() - ptrdiff(i + 1)), forward[i]);
+    }
+
+    // stepping back crosses the rows like stepping forward
+    auto it = tokens.end();
+    for (size_t i = forward.size(); i > 0; --i) {
+        --it;
+        ASSERT_EQ(*it, forward[i - 1]);
+        ASSERT_EQ(it - tokens.begin(), ptrdiff(i - 1));
+    }
+    ASSERT_THROW(--it, std::out_of_range);
+    auto last = tokens.end();
+    ASSERT_THROW(++last, std::out_of_range);
+    ASSERT_THROW(tokens.begin() + ptrdiff(forward.size() + 1), std::out_of_range);
+    ASSERT_TRUE(tokens.begin() < tokens.end());
+    ASSERT_EQ((tokens.begin() + 4).getLine().line_number, 2);
+
+    auto reversed = tokens.rbegin();
+    reversed += 3;
+    ASSERT_EQ(*reversed, forward[forward.size() - 4]);
+    reversed -= 3;
+    ASSERT_EQ(reversed, tokens.rbegin());
+
+    // the rows without tokens are skipped
+    lexer::LexerContaner with_empty(lexer::lexer_contaner_t {
+        lexer::TokenLine { 1, L"a", { lexer::Token(L"a") } },
+        lexer::TokenLine { 2, L"", {} },
+        lexer::TokenLine { 3, L"b c", { lexer::Token(L"b"), lexer::Token(L"c") } } });
+    std::vector<std::wstring> texts;
+    for (auto token = with_empty.begin(); token != with_empty.end(); ++token) {
+        texts.push_back(std::wstring(token->getText()));
+    }
+    ASSERT_EQ(texts, (std::vector<std::wstring> { L"a", L"b", L"c" }));
+    ASSERT_EQ((with_empty.rbegin() + 2)->getText(), L"a");
+
+    lexer::LexerContaner empty;
+    ASSERT_TRUE(empty.begin() == empty.end());
+    ASSERT_TRUE(empty.rbegin() == empty.rend());
+}
+
+static_assert(std::random_access_iterator<lexer::LexerIterator>);
+static_assert(std::random_access_iterator<lexer::LexerConstIterator>);
+static_assert(std::random_access_iterator<lexer::LexerReverseIterator>);
+static_assert(std::random_access_iterator<lexer::LexerConstReverseIterator>);
+static_assert(std::random_access_iterator<lexer::LexerUncheckedIterator>);
+static_assert(std::ranges::random_access_range<lexer::LexerContaner>);
+static_assert(std::ranges::sized_range<const lexer::LexerContaner>);
+static_assert(std::sentinel_for<std::default_sentinel_t, lexer::LexerConstIterator>);
+
+TEST(TestLexer, Test_Iterator_Ranges) {
+    const std::wstring test_code = L"a = b + c;\n"
+                                   "\n"
+                                   "/* a\n"
+                                   "comment */ d = a;\n";
+    const auto tokens = LEXER.createTokens(test_code);
+
+    std::vector<lexer::Token> checked(tokens.begin(), tokens.end());
+    ASSERT_EQ(checked.size(), tokens.getSize());
+    ASSERT_EQ(std::ranges::size(tokens), tokens.getSize());
+    // the "a" of the comment is a part of its text
+    ASSERT_EQ(std::ranges::count(tokens, lexer::Token(L"a")), 2);
+    ASSERT_EQ(std::ranges::find(tokens, lexer::Token(L"d")) - tokens.begin(), 11);
+
+    // the unchecked range visits the same tokens
+    auto unchecked = tokens.unchecked();
+    ASSERT_EQ(unchecked.size(), checked.size());
+    ASSERT_TRUE(std::ranges::equal(unchecked, checked));
+    ASSERT_EQ(unchecked[4], checked[4]);
+
+    size_t n = 0;
+    for (auto it = tokens.begin(); it != std::default_sentinel; ++it) {
+        ASSERT_EQ(*it, checked[n++]);
+    }
+    ASSERT_EQ(n, checked.size());
+
+    lexer::LexerConstIterator empty;
+    ASSERT_TRUE(empty == std::default_sentinel);
+
+    // the tokens are made from the columns and refer to the text of the container
+    for (size_t i = 0; i < tokens.getSize(); ++i) {
+        ASSERT_EQ((tokens.begin() + ptrdiff_t(i))->getText().data(),
+                  tokens.getTokenText(i).data());
+        ASSERT_EQ(tokens.rbegin()[ptrdiff_t(tokens.getSize() - 1 - i)].getId(),
+                  tokens.getIds()[i]);
+    }
+    ASSERT_EQ((tokens.rbegin() + 1).getLine().line_number, 3);
+}
@@ -0,0 +1,111 @@
+#include "../include/lexer/lexer.h"
+#include "../include/lexer/unicode.h"
+#include "lexer-test-helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+static const std::vector<lexer::CombiningTokens> COMBINING_TOKENS = {
+    lexer::CombiningTokens { lexer::Token(L"\""), lexer::Token(L"\"") },
+    lexer::CombiningTokens { lexer::Token(L"//"), lexer::Token(L"\n") },
+    lexer::CombiningTokens { lexer::Token(L"/*"), lexer::Token(L"*/") },
+    lexer::CombiningTokens { lexer::Token(L"<!--"), lexer::Token(L"-->") }
+};
+
+template <class CharT> struct SessionToken {
+    std::basic_string<CharT> text;
+    uint64_t id;
+    size_t line_number;
+    size_t position;
+};
+
+// feeds the code in pieces of random sizes and checks the tokens against the container
+template <class CharT>
+static void expectSameTokens(lexer::BasicLexer<CharT>& lexer,
+                             const std::basic_string<CharT>& code, std::mt19937& random) {
+    std::vector<SessionToken<CharT>> tokens;
+    auto session = lexer.createSession([&tokens](const auto& token) {
+        tokens.push_back({ std::basic_string<CharT>(token.token.getText()),
+                           token.token.getId(), token.line_number, token.position });
+    });
+    std::uniform_int_distribution<size_t> piece(0, 7);
+    for (size_t i = 0; i < code.size();) {
+        size_t n = std::min(piece(random), code.size() - i);
+        session.feed(code.data() + i, n);
+        i += n;
+    }
+    session.finish();
+    ASSERT_TRUE(session.isFinished());
+
+    auto expected = lexer.createTokens(code);
+    size_t k = 0;
+    for (size_t i = 0; i < expected.getLinesNumber(); ++i) {
+        const auto& line = expected[i];
+        for (const auto& expected_token : line.tokens) {
+            ASSERT_LT(k, tokens.size());
+            ASSERT_TRUE(tokens[k].text == expected_token.getText());
+            ASSERT_EQ(tokens[k].id, expected_token.getId());
+            ASSERT_EQ(tokens[k].line_number, line.line_number);
+            ASSERT_TRUE(line.original.substr(tokens[k].position, tokens[k].text.size()) ==
+                        tokens[k].text);
+            ++k;
+        }
+    }
+    ASSERT_EQ(k, tokens.size());
+}
+
+TEST(LexerSessionTest, Test_Session_SameTokens) {
+    std::mt19937 random(47);
+    lexer::Lexer lexer({ L"+-/*=<>!", L"й𝔸" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t");
+    lexer::BasicLexer<char8_t> u8_lexer({ u8"+-/*=<>!", u8"й𝔸" }, u8"&?;(){}\n",
+                                        { { lexer::BasicToken<char8_t>(u8"/*"),
+                                            lexer::BasicToken<char8_t>(u8"*/") },
+                                          { lexer::BasicToken<char8_t>(u8"й𝔸"),
+                                            lexer::BasicToken<char8_t>(u8"𝔸й") } },
+                                        u8" \t");
+    lexer::BasicLexer<char16_t> u16_lexer({ u"+-/*=<>!", u"й𝔸" }, u"&?;(){}\n",
+                                          { { lexer::BasicToken<char16_t>(u"<!--"),
+                                              lexer::BasicToken<char16_t>(u"-->") } },
+                                          u" \t");
+    for (size_t i = 0; i < 500; ++i) {
+        std::wstring code = randomCode(random, i % 100, RANDOM_CODE_CHARS + L"𝔸");
+        expectSameTokens(lexer, code, random);
+        expectSameTokens(u8_lexer, lexer::fromWide<char8_t>(code), random);
+        expectSameTokens(u16_lexer, lexer::fromWide<char16_t>(code), random);
+    }
+}
+
+TEST(LexerSessionTest, Test_Session_LongRegion) {
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t");
+    std::vector<lexer::Token> tokens;
+    std::vector<size_t> lines;
+    auto session = lexer.createSession([&](const lexer::StreamToken& token) {
+        tokens.push_back(lexer::Token(std::wstring(token.token.getText())));
+        lines.push_back(token.line_number);
+    });
+
+    std::wstring body;
+    session.feed(L"a /");
+    session.feed(L"*");
+    for (size_t i = 0; i < 1000; ++i) {
+        std::wstring piece = i % 10 ? L"xxxx*" : L"\nyyyy";
+        body += piece;
+        session.feed(piece);
+    }
+    ASSERT_EQ(tokens.size(), 2);
+    // the last star of the body and the next slash close the comment
+    body.pop_back();
+    session.feed(L"/ b\nc");
+    ASSERT_EQ(tokens.size(), 6);
+    session.finish();
+    ASSERT_THROW(session.feed(L"d"), std::runtime_error);
+
+    ASSERT_EQ(tokens.size(), 7);
+    ASSERT_EQ(tokens[1].getText(), L"/*");
+    ASSERT_EQ(tokens[2].getText(), body);
+    ASSERT_EQ(tokens[3].getText(), L"*/");
+    ASSERT_EQ(tokens[4].getText(), L"b");
+    ASSERT_EQ(lines[5], 1);
+    ASSERT_EQ(lines[6], 2 + 100);
+}
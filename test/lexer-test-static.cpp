@@ -0,0 +1,99 @@
+#include "../include/lexer/lexer.h"
+#include "../include/lexer/static-lexer.h"
+#include "lexer-test-helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+struct CSpec {
+    static constexpr std::wstring_view special_alphabets[] = { L"+-/*=<>!", L"йb" };
+    static constexpr std::wstring_view individual_chars = L"&?;$#@^:\"'|.,(){}[]\n";
+    static constexpr std::pair<std::wstring_view, std::wstring_view>
+        combining_tokens[] = {
+            { L"\"", L"\"" }, { L"//", L"\n" }, { L"/*", L"*/" }, { L"й/", L"й" }
+        };
+    static constexpr std::wstring_view separators = L" \t";
+};
+
+struct EmptySpec {
+    static constexpr std::array<std::wstring_view, 0> special_alphabets = {};
+    static constexpr std::wstring_view individual_chars = L"";
+    static constexpr std::array<std::pair<std::wstring_view, std::wstring_view>, 0>
+        combining_tokens = {};
+    static constexpr std::wstring_view separators = L" ";
+};
+
+static std::vector<lexer::CombiningTokens> combiningTokens() {
+    std::vector<lexer::CombiningTokens> combining_tokens;
+    for (const auto& [start, end] : CSpec::combining_tokens) {
+        combining_tokens.push_back(lexer::CombiningTokens {
+            lexer::Token(std::wstring(start)), lexer::Token(std::wstring(end)) });
+    }
+    return combining_tokens;
+}
+
+TEST(LexerStaticTest, Test_Static_SameTokens) {
+    constexpr lexer::StaticLexer<CSpec> static_lexer;
+    lexer::Lexer lexer({ L"+-/*=<>!", L"йb" }, std::wstring(CSpec::individual_chars),
+                       combiningTokens(), std::wstring(CSpec::separators));
+    lexer::LexerDfa dfa({ L"+-/*=<>!", L"йb" }, std::wstring(CSpec::individual_chars),
+                        combiningTokens(), std::wstring(CSpec::separators));
+    ASSERT_EQ(static_lexer.getStatesNumber(), dfa.getStatesNumber());
+
+    std::mt19937 random(11);
+    for (size_t n = 0; n < 200; ++n) {
+        std::wstring code = randomCode(random, 300);
+        auto expected = lexer.createTokens(code);
+        expectSameTokens<wchar_t>(expected, static_lexer.createTokens(code), code);
+        expectSameTokens<char>(expected,
+                               static_lexer.createTokens(lexer::wideToUtf8(code)), code);
+        expectSameTokens<char16_t>(
+            expected, static_lexer.createTokens(lexer::wideToUtf16(code)), code);
+    }
+}
+
+TEST(LexerStaticTest, Test_Static_KeywordIds) {
+    constexpr lexer::StaticLexer<CSpec> static_lexer;
+    auto tokens = static_lexer.createTokens(L"return x;\nwhile (y) {}\n");
+
+    size_t keywords = 0;
+    for (const auto& token : tokens) {
+        switch (token.getId()) {
+            case lexer::StaticLexer<CSpec>::tokenId(L"return"):
+            case lexer::StaticLexer<CSpec>::tokenId(L"while"):
+                ++keywords;
+                break;
+            default:
+                break;
+        }
+    }
+    ASSERT_EQ(keywords, 2);
+    ASSERT_EQ(tokens.getLine(0).tokens.at(0).getId(), lexer::defineTokenId(L"return"));
+}
+
+TEST(LexerStaticTest, Test_Static_EmptySpec) {
+    static_assert(lexer::StaticLexer<EmptySpec>::getStatesNumber() > 0);
+    lexer::StaticLexer<EmptySpec> static_lexer;
+    auto tokens = static_lexer.createTokens(u8"a b\nc");
+
+    ASSERT_EQ(tokens.getSize(), 3);
+    ASSERT_EQ(tokens.getLinesNumber(), 2);
+}
+
+struct OverlappingSpec {
+    static constexpr std::wstring_view special_alphabets[] = { L"0123456789",
+                                                               L"0123456789abcdef" };
+    static constexpr std::wstring_view individual_chars = L"\n";
+    static constexpr std::array<std::pair<std::wstring_view, std::wstring_view>, 0>
+        combining_tokens = {};
+    static constexpr std::wstring_view separators = L" ";
+};
+
+TEST(LexerStaticTest, Test_Static_OverlappingAlphabets) {
+    lexer::StaticLexer<OverlappingSpec> static_lexer;
+    auto tokens = static_lexer.createTokens(L"x = ff00 + 12\n");
+
+    ASSERT_EQ(tokens.getSize(), 6);
+    ASSERT_EQ(tokens.getLine(0).tokens.at(2).getText(), L"ff00");
+}
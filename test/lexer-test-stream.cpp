@@ -0,0 +1,80 @@
+#include "../include/lexer/lexer.h"
+#include "../include/lexer/unicode.h"
+#include "lexer-test-helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+static const std::vector<lexer::CombiningTokens> COMBINING_TOKENS = {
+    lexer::CombiningTokens { lexer::Token(L"\""), lexer::Token(L"\"") },
+    lexer::CombiningTokens { lexer::Token(L"//"), lexer::Token(L"\n") },
+    lexer::CombiningTokens { lexer::Token(L"/*"), lexer::Token(L"*/") }
+};
+
+template <class CharT>
+static void expectSameTokens(const lexer::BasicLexerContaner<CharT>& expected,
+                             lexer::BasicLexerStream<CharT> stream) {
+    lexer::BasicStreamToken<CharT> token;
+    for (size_t i = 0; i < expected.getLinesNumber(); ++i) {
+        const auto& line = expected[i];
+        for (const auto& expected_token : line.tokens) {
+            ASSERT_TRUE(stream.nextToken(token));
+            ASSERT_TRUE(token.token == expected_token);
+            ASSERT_EQ(token.line_number, line.line_number);
+            auto text = token.token.getText();
+            ASSERT_TRUE(line.original.substr(token.position, text.size()) == text);
+        }
+    }
+    ASSERT_FALSE(stream.nextToken(token));
+    ASSERT_TRUE(stream.isFinished());
+}
+
+TEST(LexerStreamTest, Test_Stream_SameTokens) {
+    std::mt19937 random(31);
+    lexer::Lexer lexer({ L"+-/*=<>!", L"йb" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t");
+    lexer::BasicLexer<char8_t> u8_lexer({ u8"+-/*=<>!", u8"йb" }, u8"&?;(){}\n",
+                                        { { lexer::BasicToken<char8_t>(u8"/*"),
+                                            lexer::BasicToken<char8_t>(u8"*/") },
+                                          { lexer::BasicToken<char8_t>(u8"\""),
+                                            lexer::BasicToken<char8_t>(u8"\"") } },
+                                        u8" \t");
+    for (size_t i = 0; i < 500; ++i) {
+        std::wstring code = randomCode(random, i % 80);
+        expectSameTokens(lexer.createTokens(code), lexer.createStream(code));
+
+        std::u8string u8_code = lexer::fromWide<char8_t>(code);
+        expectSameTokens(u8_lexer.createTokens(u8_code),
+                         u8_lexer.createStream(u8_code));
+    }
+}
+
+TEST(LexerStreamTest, Test_Stream_OnDemand) {
+    lexer::Lexer lexer({ L"+-/*=<>!" }, L"&?;(){}\n", COMBINING_TOKENS, L" \t");
+    std::wstring code = L"a = /* b\nc */ d;\n\"e\"";
+    for (size_t i = 0; i < 1000; ++i) {
+        code += L"\nf + g;";
+    }
+    auto stream = lexer.createStream(code);
+
+    lexer::StreamToken token;
+    ASSERT_TRUE(stream.nextToken(token));
+    ASSERT_EQ(token.token.getText(), L"a");
+    ASSERT_EQ(token.token.getId(), lexer::defineTokenId(L"a"));
+    ASSERT_FALSE(stream.isFinished());
+
+    std::vector<lexer::StreamToken> tokens;
+    for (const auto& next : stream) {
+        tokens.push_back(next);
+    }
+    ASSERT_TRUE(stream.isFinished());
+    ASSERT_EQ(tokens.size(), lexer.createTokens(code).getSize() - 1);
+    ASSERT_EQ(tokens.at(1).token.getText(), L"/*");
+    ASSERT_EQ(tokens.at(2).token.getText(), L" b\nc ");
+    ASSERT_EQ(tokens.at(4).line_number, 1);
+    ASSERT_EQ(tokens.at(4).position, 14);
+    ASSERT_EQ(tokens.at(7).line_number, 3);
+    ASSERT_EQ(tokens.at(7).token.getText(), L"\"e\"");
+    ASSERT_EQ(tokens.back().token.getText(), L";");
+    ASSERT_EQ(tokens.back().line_number, 1003);
+}